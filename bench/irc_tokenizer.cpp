@@ -0,0 +1,135 @@
+// measures how fast incoming IRC traffic is split into lines and tokenized,
+// the way `irc_client::run_inner` does it: reads go into a `line_buffer` and
+// every line goes through `message_view::from_chars`
+//
+// usage: john_bot_bench_irc_tokenizer [iterations] [capture]
+//
+// `capture` is a file of raw traffic as received from a server (CRLF line
+// endings), a built-in sample is used if there is none
+
+#include <irc/line_buffer.hpp>
+#include <irc/message.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+// a join burst, some chatter and the usual server noise
+constexpr auto sample_traffic = std::string_view{
+  ":irc.example.net 001 john :Welcome to the ExampleNet IRC Network john!john@203.0.113.7\r\n"
+  ":irc.example.net 005 john AWAYLEN=200 CASEMAPPING=rfc1459 CHANMODES=beI,k,l,BCMNORScimnpstz CHANTYPES=# ELIST=CMNTU HOSTLEN=64 KEYLEN=32 :are supported by this server\r\n"
+  ":john!john@203.0.113.7 JOIN #rust\r\n"
+  ":irc.example.net 332 john #rust :Rust discussion | https://www.rust-lang.org | be nice\r\n"
+  ":irc.example.net 353 john = #rust :john @ChanServ +amy rory clara doctor river_song martha donna jack ianto gwen owen tosh\r\n"
+  ":irc.example.net 366 john #rust :End of /NAMES list.\r\n"
+  ":amy!~amy@user/amy PRIVMSG #rust :has anyone tried the new borrow checker diagnostics yet?\r\n"
+  ":rory!~rory@2001:db8::1f PRIVMSG #rust :yeah, the suggestions for lifetimes got a lot better\r\n"
+  ":clara!clara@gateway/web/irccloud.com/x-abcdefghijklmnop PRIVMSG #rust :\x01" "ACTION waves\x01\r\n"
+  ":doctor!~doctor@tardis.example.org JOIN #rust\r\n"
+  ":martha!martha@198.51.100.23 PART #rust :Leaving\r\n"
+  "PING :irc.example.net\r\n"
+  ":ChanServ!ChanServ@services.example.net MODE #rust +o doctor\r\n"
+  ":donna!~donna@user/donna QUIT :Ping timeout: 252 seconds\r\n"
+  ":river_song!river@library.example.com PRIVMSG #rust :spoilers, but the answer is to use an arena and hand out indices instead of references\r\n"
+  ":NickServ!NickServ@services.example.net NOTICE john :This nickname is registered. Please choose a different nickname, or identify via /msg NickServ identify <password>\r\n"
+  ":jack!~jack@torchwood.example.co.uk PRIVMSG john :hey, are you the relay bot?\r\n"
+  ":irc.example.net 433 * john :Nickname is already in use.\r\n"
+};
+
+auto arg_or(int argc, char** argv, int n, usize default_value) -> usize {
+    if (argc <= n) {
+        return default_value;
+    }
+
+    auto ret = default_value;
+    std::from_chars(argv[n], argv[n] + std::strlen(argv[n]), ret);
+    return ret;
+}
+
+struct run_result {
+    std::chrono::duration<double> m_elapsed;
+    usize m_lines;
+    usize m_params;
+};
+
+// feeds the traffic in reads of `read_size` bytes, like a socket would
+auto run_once(std::string_view traffic, usize iterations, usize read_size) -> run_result {
+    auto buffer = john::irc::line_buffer{};
+    auto ret = run_result{};
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0uz; i < iterations; i++) {
+        for (auto rest = traffic; !rest.empty();) {
+            auto space = buffer.prepare();
+            const auto count = std::min({space.size(), rest.size(), read_size});
+
+            std::memcpy(space.data(), rest.data(), count);
+            buffer.commit(count);
+            rest.remove_prefix(count);
+
+            for (;;) {
+                auto line = buffer.next_line();
+                if (!line) {
+                    continue;
+                }
+
+                if (!*line) {
+                    break;
+                }
+
+                auto message = john::irc::message_view::from_chars((*line)->m_text, std::move((*line)->m_storage));
+                if (message) {
+                    ret.m_lines++;
+                    ret.m_params += message->params().size() + (message->m_trailing ? 1uz : 0uz);
+                }
+            }
+        }
+    }
+
+    ret.m_elapsed = std::chrono::steady_clock::now() - start;
+    return ret;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    const auto iterations = arg_or(argc, argv, 1, 20'000uz);
+
+    auto traffic = std::string{sample_traffic};
+    if (argc > 2) {
+        auto file = std::ifstream{argv[2], std::ios::binary};
+        if (!file) {
+            spdlog::error("could not open {}", argv[2]);
+            return 1;
+        }
+
+        traffic.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+
+    fmt::println("tokenizing {} bytes of traffic {} times", traffic.size(), iterations);
+    fmt::println("{:>10} {:>12} {:>14} {:>10}", "read size", "seconds", "lines/s", "MiB/s");
+
+    for (auto read_size : {64uz, 512uz, 4096uz}) {
+        const auto res = run_once(traffic, iterations, read_size);
+        const auto seconds = res.m_elapsed.count();
+
+        // keeps the parse from being optimized away
+        if (res.m_params == 0uz) {
+            spdlog::warn("no parameters were parsed");
+        }
+
+        fmt::println(
+          "{:>10} {:>12.3f} {:>14.0f} {:>10.1f}", read_size, seconds, static_cast<double>(res.m_lines) / seconds,  //
+          static_cast<double>(traffic.size() * iterations) / seconds / (1024.0 * 1024.0)
+        );
+    }
+
+    return 0;
+}
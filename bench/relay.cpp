@@ -0,0 +1,255 @@
+// measures how many relayed messages per second the bot can push through
+// `things::relay` into a number of sink connectors, for varying thread counts,
+// and how many mailbox deliveries every relayed message costs
+//
+// usage: john_bot_bench_relay [messages] [sinks]
+
+#include <bot.hpp>
+#include <sqlite/exec.hpp>
+#include <sqlite/sqlite.hpp>
+#include <things/relay.hpp>
+
+#include <stuff/core/visitor.hpp>
+
+#include <spdlog/spdlog.h>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace asio = boost::asio;
+using anyhow::result;
+using asio::awaitable;
+
+namespace {
+
+struct bench_state {
+    usize m_expected;
+    std::atomic<usize> m_received{0uz};
+};
+
+struct source final : john::thing {
+    source(usize messages, john::payload_mask interests)
+        : m_messages(messages)
+        , m_interests(interests) {}
+
+    auto get_id() const -> std::string_view override { return "bench_source"; }
+
+    auto interests() const -> john::payload_mask override { return m_interests; }
+
+    auto worker(john::bot& bot) -> awaitable<result<void>> override {
+        for (auto i = 0uz; i < m_messages; i++) {
+            co_await bot.queue_message(john::message{
+              .m_from = get_id(),
+              .m_to = "",
+
+              .m_serial = 0uz,
+              .m_reply_serial = std::nullopt,
+
+              .m_payload =
+                john::payloads::incoming_message{
+                  .m_sender_identifier = {{"ident", "bench_source"}, {"nick", "bencher"}},
+                  .m_return_to_sender = {{"ident", "bench_source"}, {"target", "#src"}},
+                  .m_content = "the quick brown fox jumps over the lazy dog",
+                },
+            });
+        }
+
+        co_return result<void>{};
+    }
+
+    auto handle(john::message const&) -> awaitable<result<void>> override { co_return result<void>{}; }
+
+private:
+    usize m_messages;
+    john::payload_mask m_interests;
+};
+
+struct sink final : john::thing {
+    sink(bench_state& state, usize no, john::payload_mask interests)
+        : m_state(state)
+        , m_id(fmt::format("bench_sink_{}", no))
+        , m_interests(interests) {}
+
+    auto get_id() const -> std::string_view override { return m_id; }
+
+    auto interests() const -> john::payload_mask override { return m_interests; }
+
+    auto connector_ident() const -> std::optional<std::string_view> override { return m_id; }
+
+    auto worker(john::bot& bot) -> awaitable<result<void>> override {
+        m_bot = &bot;
+        co_return result<void>{};
+    }
+
+    auto handle(john::message const& msg) -> awaitable<result<void>> override {
+        const auto visitor = stf::multi_visitor{
+          [this](john::payloads::outgoing_message const& payload) -> usize { return payload.m_target["ident"] == m_id ? 1uz : 0uz; },
+          [this](john::payloads::multicast_message const& payload) -> usize {
+              return static_cast<usize>(std::ranges::count_if(payload.m_targets, [this](auto const& target) { return target["ident"] == m_id; }));
+          },
+          [](auto const&) -> usize { return 0uz; },
+        };
+
+        const auto received = std::visit(visitor, msg.m_payload);
+        if (received == 0uz) {
+            co_return result<void>{};
+        }
+
+        if (m_state.m_received.fetch_add(received) + received != m_state.m_expected) {
+            co_return result<void>{};
+        }
+
+        co_await m_bot->queue_message(john::message{
+          .m_from = get_id(),
+          .m_to = "",
+
+          .m_serial = 0uz,
+          .m_reply_serial = std::nullopt,
+
+          .m_payload = john::payloads::exit{},
+        });
+
+        co_return result<void>{};
+    }
+
+private:
+    bench_state& m_state;
+    std::string m_id;
+    john::payload_mask m_interests;
+    john::bot* m_bot = nullptr;
+};
+
+template<typename Thing, typename... Args>
+auto add_thing(john::bot& bot, Args&&... args) -> awaitable<void> {
+    co_await bot.queue_message(john::message{
+      .m_from = "",
+      .m_to = "bot",
+
+      .m_serial = 0uz,
+      .m_reply_serial = std::nullopt,
+
+      .m_payload =
+        john::payloads::add_thing{
+          .m_thing = std::make_unique<Thing>(std::forward<Args>(args)...),
+        },
+    });
+}
+
+auto make_database(usize sinks) -> result<sqlite::database> {
+    auto db = TRY(sqlite::open(":memory:"));
+
+    TRY(sqlite::exec(*db, "create table relay_mappings (from_kv text not null, to_kv text not null, primary key (from_kv, to_kv))"));
+
+    auto mappings = std::vector<std::tuple<std::string, std::string>>{};
+    for (auto i = 0uz; i < sinks; i++) {
+        mappings.emplace_back("ident:bench_source;target:#src", fmt::format("ident:bench_sink_{};target:#dst", i));
+    }
+
+    TRY(sqlite::exec_many(*db, "insert into relay_mappings (from_kv, to_kv) values (?, ?)", mappings));
+
+    return db;
+}
+
+struct run_result {
+    std::chrono::duration<double> m_elapsed;
+    usize m_deliveries;
+};
+
+auto run_once(usize threads, usize messages, usize sinks, bool precise_interests) -> result<run_result> {
+    auto db = TRY(make_database(sinks));
+
+    auto context = asio::io_context{static_cast<int>(threads)};
+    auto executor = asio::any_io_executor{context.get_executor()};
+
+    auto state = bench_state{.m_expected = messages * sinks};
+    auto bot = john::bot(db, executor, john::bot_configuration{.m_worker_threads = threads});
+
+    asio::co_spawn(
+      executor,
+      [&] -> awaitable<void> {
+          const auto sink_interests = precise_interests ? john::payload_mask_of<john::payloads::outgoing_message, john::payloads::multicast_message>() : john::all_payloads;
+          const auto source_interests = precise_interests ? john::payload_mask{0} : john::all_payloads;
+
+          co_await add_thing<john::things::relay>(bot);
+          for (auto i = 0uz; i < sinks; i++) {
+              co_await add_thing<sink>(bot, state, i, sink_interests);
+          }
+          co_await add_thing<source>(bot, messages, source_interests);
+      },
+      asio::detached
+    );
+
+    asio::co_spawn(executor, [&] -> awaitable<void> { co_await bot.run(); }, asio::detached);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+        auto pool = std::vector<std::jthread>{};
+        for (auto i = 1uz; i < threads; i++) {
+            pool.emplace_back([&context] { context.run(); });
+        }
+        context.run();
+    }
+
+    return run_result{
+      .m_elapsed = std::chrono::steady_clock::now() - start,
+      .m_deliveries = bot.get_delivery_count(),
+    };
+}
+
+auto arg_or(int argc, char** argv, int n, usize default_value) -> usize {
+    if (argc <= n) {
+        return default_value;
+    }
+
+    auto ret = default_value;
+    std::from_chars(argv[n], argv[n] + std::strlen(argv[n]), ret);
+    return ret;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto messages = arg_or(argc, argv, 1, 20'000uz);
+    const auto sinks = arg_or(argc, argv, 2, 4uz);
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    fmt::println("relaying {} messages into {} sinks", messages, sinks);
+    fmt::println("{:>8} {:>12} {:>14}", "threads", "seconds", "deliveries/s");
+
+    for (auto threads = 1uz; threads <= max_threads; threads *= 2) {
+        auto res = run_once(threads, messages, sinks, true);
+        if (!res) {
+            spdlog::error("benchmark failed: {}", static_cast<john::error const&>(res.error()));
+            return 1;
+        }
+
+        const auto seconds = res->m_elapsed.count();
+        fmt::println("{:>8} {:>12.3f} {:>14.0f}", threads, seconds, static_cast<double>(messages * sinks) / seconds);
+    }
+
+    fmt::println("");
+    fmt::println("{:>10} {:>12} {:>20}", "interests", "seconds", "deliveries/message");
+
+    for (auto precise : {false, true}) {
+        auto res = run_once(1uz, messages, sinks, precise);
+        if (!res) {
+            spdlog::error("benchmark failed: {}", static_cast<john::error const&>(res.error()));
+            return 1;
+        }
+
+        fmt::println(
+          "{:>10} {:>12.3f} {:>20.2f}", precise ? "precise" : "all",  //
+          res->m_elapsed.count(), static_cast<double>(res->m_deliveries) / static_cast<double>(messages)
+        );
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stuff/core/integers.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <vector>
+
+namespace john {
+
+struct bloom_filter_configuration {
+    // per generation, rounded up to a power of two
+    usize m_bits = 1uz << 16;
+    usize m_hashes = 4uz;
+
+    // an insertion is remembered for at least this long and at most twice as
+    // long
+    std::chrono::steady_clock::duration m_ttl = std::chrono::seconds(30);
+};
+
+struct bloom_filter_stats {
+    usize m_insertions;
+    usize m_queries;
+    usize m_hits;
+    usize m_rotations;
+};
+
+// a bloom filter over 64 bit fingerprints that forgets things over time
+//
+// - there are two generations, insertions go to the current one and lookups
+//   check both. once the current generation is older than the ttl it becomes
+//   the previous one and the old previous one gets cleared.
+// - memory use is fixed at 2 * m_bits bits.
+// - false positives are possible (that's the point), false negatives aren't,
+//   within the ttl.
+// - not thread safe.
+struct rotating_bloom_filter {
+    using clock = std::chrono::steady_clock;
+
+    explicit rotating_bloom_filter(bloom_filter_configuration config = {})
+        : m_config(config)
+        , m_mask(std::bit_ceil(std::max(config.m_bits, 64uz)) - 1)
+        , m_current((m_mask + 1) / 64)
+        , m_previous((m_mask + 1) / 64) {}
+
+    void insert(u64 fingerprint, clock::time_point now = clock::now()) {
+        rotate_if_needed(now);
+        m_insertions++;
+
+        for_each_bit(fingerprint, [this](usize bit) { m_current[bit / 64] |= u64{1} << (bit % 64); });
+    }
+
+    auto contains(u64 fingerprint, clock::time_point now = clock::now()) -> bool {
+        rotate_if_needed(now);
+        m_queries++;
+
+        const auto in = [this, fingerprint](std::vector<u64> const& generation) {
+            auto ret = true;
+            for_each_bit(fingerprint, [&](usize bit) { ret &= ((generation[bit / 64] >> (bit % 64)) & 1) != 0; });
+            return ret;
+        };
+
+        const auto ret = in(m_current) || in(m_previous);
+        m_hits += ret ? 1uz : 0uz;
+
+        return ret;
+    }
+
+    auto stats() const -> bloom_filter_stats {
+        return {
+          .m_insertions = m_insertions,
+          .m_queries = m_queries,
+          .m_hits = m_hits,
+          .m_rotations = m_rotations,
+        };
+    }
+
+private:
+    bloom_filter_configuration m_config;
+    usize m_mask;
+
+    std::vector<u64> m_current;
+    std::vector<u64> m_previous;
+    clock::time_point m_rotated_at = clock::now();
+
+    usize m_insertions = 0uz;
+    usize m_queries = 0uz;
+    usize m_hits = 0uz;
+    usize m_rotations = 0uz;
+
+    void rotate_if_needed(clock::time_point now) {
+        if (now - m_rotated_at < m_config.m_ttl) {
+            return;
+        }
+
+        // nothing in the current generation is worth keeping either if two
+        // ttls have passed
+        if (now - m_rotated_at >= 2 * m_config.m_ttl) {
+            std::ranges::fill(m_current, u64{0});
+        }
+
+        std::swap(m_current, m_previous);
+        std::ranges::fill(m_current, u64{0});
+
+        m_rotated_at = now;
+        m_rotations++;
+    }
+
+    // double hashing, see "Less Hashing, Same Performance" by Kirsch and
+    // Mitzenmacher
+    template<typename Fun>
+    void for_each_bit(u64 fingerprint, Fun&& fun) const {
+        const auto h1 = fingerprint;
+        const auto h2 = (std::rotl(fingerprint, 32) * 0x9E37'79B9'7F4A'7C15ull) | 1;
+
+        for (auto i = 0uz; i < m_config.m_hashes; i++) {
+            fun(static_cast<usize>((h1 + i * h2) & m_mask));
+        }
+    }
+};
+
+}  // namespace john
@@ -2,24 +2,30 @@
 
 #include <assio/as_expected.hpp>
 #include <error.hpp>
+#include <gate.hpp>
 #include <kv.hpp>
+#include <mailbox.hpp>
+#include <permissions.hpp>
+#include <sqlite/async.hpp>
 #include <sqlite/database.hpp>
 
 #include <spdlog/spdlog.h>
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/experimental/concurrent_channel.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
 
 namespace john {
 
 struct bot;
 struct thing;
 
-enum class user_level : int {
-    regular = 0,
-    admin = 1,
-    op = 2,
-};
-
 namespace payloads {
 
 struct incoming_message {
@@ -33,7 +39,8 @@ struct command_decl {
     std::string_view m_command;
     std::string_view m_description;
 
-    // TODO: add granular permissions
+    // users below this level can still be granted the command individually,
+    // see permission_table::grant
     user_level m_min_level;
 };
 
@@ -49,6 +56,14 @@ struct outgoing_message {
     std::string m_content;
 };
 
+// the same content going to multiple targets, possibly on different
+// connectors. every connector that owns at least one of the targets gets the
+// message once and sends it to the targets that are its own.
+struct multicast_message {
+    std::vector<mini_kv> m_targets;
+    std::shared_ptr<const std::string> m_content;
+};
+
 struct add_thing {
     std::unique_ptr<thing> m_thing;
 };
@@ -71,12 +86,37 @@ using message_payload = std::variant<
   payloads::command_decl,
   payloads::command,
   payloads::outgoing_message,
+  payloads::multicast_message,
   payloads::add_thing,
   payloads::remove_thing,
   payloads::exit,
   payloads::other
   /**/>;
 
+// a bitmask over the alternatives of message_payload
+using payload_mask = u64;
+
+static_assert(std::variant_size_v<message_payload> <= sizeof(payload_mask) * 8uz);
+
+namespace detail {
+
+template<typename T, typename... Ts>
+constexpr auto payload_index(std::type_identity<std::variant<Ts...>>) -> usize {
+    constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+    return static_cast<usize>(std::ranges::find(matches, true) - std::ranges::begin(matches));
+}
+
+}  // namespace detail
+
+template<typename... Payloads>
+constexpr auto payload_mask_of() -> payload_mask {
+    return ((payload_mask{1} << detail::payload_index<Payloads>(std::type_identity<message_payload>{})) | ... | payload_mask{0});
+}
+
+constexpr auto payload_bit(message_payload const& payload) -> payload_mask { return payload_mask{1} << payload.index(); }
+
+inline constexpr payload_mask all_payloads = ~payload_mask{0};
+
 struct message {
     std::string_view m_from;
     std::string m_to;
@@ -87,65 +127,313 @@ struct message {
     message_payload m_payload;
 };
 
+// which lane of the bus a message travels through
+enum class message_priority {
+    // bot/thing management, commands and replies
+    control,
+    // everything else (relayed chat traffic, mostly)
+    bulk,
+};
+
+auto default_priority(message const& msg) -> message_priority;
+
+using message_ptr = std::shared_ptr<const message>;
+using mailbox = basic_mailbox<message_ptr>;
+
+struct coalescing_limits {
+    // merged contents are never made longer than this, in bytes
+    usize m_max_size;
+
+    // what goes between the merged contents
+    std::string_view m_separator;
+};
+
 struct thing {
     virtual ~thing() = default;
 
     virtual auto get_id() const -> std::string_view = 0;
 
+    // the payloads that this `thing` wants to see when they are broadcast.
+    // queried once, when the `thing` is added. messages that are addressed to
+    // the `thing` directly are always delivered.
+    virtual auto interests() const -> payload_mask { return all_payloads; }
+
+    // connectors (things that own an "ident" in mini_kv targets) return their
+    // ident here. broadcast payloads::outgoing_message's are delivered only to
+    // the connector that owns m_target["ident"] (and to non-connectors that
+    // are interested in them), payloads::multicast_message's to every
+    // connector that owns one of the targets.
+    virtual auto connector_ident() const -> std::optional<std::string_view> { return std::nullopt; }
+
+    // overrides bot_configuration::m_default_mailbox for this `thing`
+    virtual auto mailbox_config() const -> std::optional<mailbox_configuration> { return std::nullopt; }
+
+    // connectors that return something here get the broadcast
+    // payloads::outgoing_message's that are meant for them merged per target,
+    // see bot_configuration::m_coalesce_window. queried once, when the `thing`
+    // is added.
+    virtual auto coalescing() const -> std::optional<coalescing_limits> { return std::nullopt; }
+
     // pins bot
     virtual auto worker(bot& bot) -> boost::asio::awaitable<anyhow::result<void>> = 0;
 
     virtual auto handle(message const&) -> boost::asio::awaitable<anyhow::result<void>> = 0;
 };
 
+struct bot_configuration {
+    // the amount of threads that will be running the io_context, every
+    // `thing` gets its own strand so this is the upper bound on the number of
+    // `thing`s that can be doing work at the same time
+    usize m_worker_threads = 1uz;
+
+    // every `thing` gets a mailbox that messages are delivered through
+    mailbox_configuration m_default_mailbox{};
+
+    // the amount of messages that can be queued before queue_message starts
+    // suspending its callers
+    usize m_bus_capacity = 256uz;
+
+    // same as above but for message_priority::control
+    usize m_control_capacity = 64uz;
+
+    // the amount of control messages bot::run may handle back to back while
+    // there are bulk messages waiting
+    usize m_control_burst = 16uz;
+
+    // producers that can hold off (socket readers) are asked to stop reading
+    // once this many messages are queued and may resume once the queue drains
+    // down to the low watermark. see bot::wait_for_bus.
+    usize m_bus_high_watermark = 192uz;
+    usize m_bus_low_watermark = 64uz;
+
+    // the threads that sqlite queries made through bot::get_async_db run on,
+    // also the amount of read only connections main opens
+    usize m_database_threads = 1uz;
+
+    // outgoing messages to the same target that arrive within this long of
+    // the first one are sent as one, see thing::coalescing. zero turns
+    // coalescing off.
+    std::chrono::milliseconds m_coalesce_window{0};
+};
+
 // john bot
 struct bot {
-    bot(sqlite::database database, boost::asio::any_io_executor& executor)
-        : m_database(std::move(database))
+    bot(sqlite::pool database, boost::asio::any_io_executor& executor, bot_configuration config = {})
+        : m_config(config)
+        , m_database(database.m_writer)
+        , m_async_database(std::move(database), config.m_database_threads)
         , m_executor(executor)
-        , m_message_channel(executor, 32uz)  // TODO: this is terrible
+        , m_control_channel(executor, config.m_control_capacity)
+        , m_message_channel(executor, config.m_bus_capacity)
+        , m_doorbell(executor, 1uz)
+        , m_flush_timer(executor)
         , m_completion_channel(executor) {}
 
     auto run() -> boost::asio::awaitable<anyhow::result<void>>;
 
     // - meant to be called by "thing"s.
     // - the message serial will be overwritten.
-    auto queue_message(message msg) -> boost::asio::awaitable<usize>;
+    // - the lane is picked with default_priority unless one is given.
+    auto queue_message(message msg, std::optional<message_priority> priority = std::nullopt) -> boost::asio::awaitable<usize>;
+
+    // - same as calling queue_message for every message in order, but the
+    //   serials are reserved at once and bot::run is woken up once for the
+    //   whole batch (unless a lane fills up in the middle).
+    // - the messages are moved out of.
+    // - returns the serial of the first message, the rest get consecutive
+    //   ones. returns 0 if `messages` is empty.
+    auto queue_messages(std::span<message> messages, std::optional<message_priority> priority = std::nullopt) -> boost::asio::awaitable<usize>;
+
+    // - queues `msg` and waits for a message whose m_reply_serial is the
+    //   serial `msg` got (see queue_a_reply).
+    // - the reply is handed to the caller instead of being routed, only the
+    //   logger gets to see it as well.
+    // - std::nullopt if there was no reply within `timeout`.
+    auto request(message msg, std::chrono::steady_clock::duration timeout, std::optional<message_priority> priority = std::nullopt)
+      -> boost::asio::awaitable<std::optional<message_ptr>>;
 
     auto queue_a_reply(message const& reply_to, std::string_view from_id, message_payload payload) -> boost::asio::awaitable<void>;
 
+    // whether the bus is above its high watermark
+    auto bus_congested() const -> bool { return !m_bus_gate.is_open(); }
+
+    // - meant to be called by producers before reading more input off of their
+    //   sockets, so that overload backs up into the kernel instead of into
+    //   queued messages and suspended coroutines.
+    // - returns immediately if the bus isn't congested.
+    auto wait_for_bus() -> boost::asio::awaitable<void>;
+
     // TODO: restrict update and insert on const when the db is being used through <sqlite/*.hpp>
-    auto get_db() const -> sqlite3& { return *m_database; }
+    auto get_db() const -> sqlite::connection& { return *m_database; }
+
+    // prefer this over get_db from coroutines running on the io_context
+    auto get_async_db() -> sqlite::async_database& { return m_async_database; }
 
     auto display_name(john::mini_kv const& kv) const -> std::optional<std::string>;
 
+    // calls `fun(std::string_view)` with the display name of `kv` without
+    // copying it out, returns false without calling `fun` if there is none
+    //
+    // the names are locked while `fun` runs, don't do anything slow in there.
+    template<typename Fun>
+    auto with_display_name(john::mini_kv const& kv, Fun&& fun) const -> bool {
+        auto _ = std::unique_lock{m_display_names_mutex};
+
+        auto it = m_display_names.find(kv);
+        if (it == m_display_names.end()) {
+            return false;
+        }
+
+        std::invoke(std::forward<Fun>(fun), std::string_view{it->second});
+        return true;
+    }
+
+    auto get_permissions() -> permission_table& { return m_permissions; }
+
     void set_display_name(john::mini_kv const& kv, std::string name);
 
     auto get_executor() -> boost::asio::any_io_executor& { return m_executor; }
 
+    auto get_config() const -> bot_configuration const& { return m_config; }
+
+    auto get_mailbox_stats(std::string_view thing_id) const -> std::optional<mailbox_stats>;
+
+    // the amount of times a message has been put in a mailbox
+    auto get_delivery_count() const -> usize { return m_deliveries.load(std::memory_order_relaxed); }
+
+    // the amount of outgoing messages that have been merged into another one
+    auto get_coalesced_count() const -> usize { return m_coalesced.load(std::memory_order_relaxed); }
+
 private:
+    using strand_type = boost::asio::strand<boost::asio::any_io_executor>;
+
+    struct thing_entry {
+        std::unique_ptr<thing> m_thing;
+
+        // the worker and every call to `thing::handle` run on this strand
+        strand_type m_strand;
+
+        // drained by a consumer running on m_strand
+        std::unique_ptr<mailbox> m_mailbox;
+
+        payload_mask m_interests;
+
+        bool m_connector;
+
+        std::optional<coalescing_limits> m_coalescing;
+    };
+
+    bot_configuration m_config;
+
     sqlite::database m_database;
+    sqlite::async_database m_async_database;
     boost::asio::any_io_executor& m_executor;
 
-    std::unordered_map<std::string, std::unique_ptr<thing>> m_things;
+    // guards m_things and m_declared_commands. never hold across a co_await.
+    mutable std::shared_mutex m_things_mutex{};
+    std::unordered_map<std::string, thing_entry> m_things;
+
+    // keyed by thing::connector_ident, the keys point into the `thing`s
+    std::unordered_map<std::string_view, thing_entry const*> m_connectors;
+
+    // loaded when bot::run starts
+    permission_table m_permissions{};
 
     mutable std::mutex m_display_names_mutex{};
     std::unordered_map<john::mini_kv, std::string> m_display_names{};
 
-    std::unordered_map<std::string_view, payloads::command_decl> m_declared_commands{};
+    struct declared_command {
+        payloads::command_decl m_decl;
+
+        // commands are delivered only to the `thing` that declared them,
+        // nullptr if they weren't declared by a registered `thing`
+        thing_entry const* m_owner;
+    };
+
+    std::unordered_map<std::string_view, declared_command> m_declared_commands{};
 
     std::atomic<usize> m_previous_serial{1uz};
 
-    assify<boost::asio::experimental::concurrent_channel<void(boost::system::error_code, message)>> m_message_channel;
+    std::atomic<usize> m_deliveries{0uz};
+
+    // messages that have been queued but not yet received by bot::run
+    std::atomic<usize> m_bus_depth{0uz};
+    gate m_bus_gate{};
+
+    using lane_type = assify<boost::asio::experimental::concurrent_channel<void(boost::system::error_code, message)>>;
+
+    lane_type m_control_channel;
+    lane_type m_message_channel;
+
+    // rung after every send so that bot::run can wait on both lanes at once
+    assify<boost::asio::experimental::concurrent_channel<void(boost::system::error_code)>> m_doorbell;
+
+    // only touched by bot::run
+    usize m_control_streak = 0uz;
+    bool m_exiting = false;
+
+    // outgoing messages waiting for more to be merged into them
+    struct pending_batch {
+        thing_entry const* m_connector;
+
+        // sent as is if nothing gets merged into it
+        message_ptr m_first;
+        // empty until something does
+        std::string m_content;
+        usize m_merged = 1uz;
+
+        std::chrono::steady_clock::time_point m_deadline;
+    };
+
+    // only touched by bot::run, like everything that delivers to a connector
+    std::unordered_map<mini_kv, pending_batch> m_pending_batches{};
+    std::chrono::steady_clock::time_point m_next_flush = std::chrono::steady_clock::time_point::max();
+    std::atomic<usize> m_coalesced{0uz};
+
+    // rings m_doorbell when the earliest batch is due
+    boost::asio::steady_timer m_flush_timer;
+
+    using reply_channel = assify<boost::asio::experimental::concurrent_channel<void(boost::system::error_code, message_ptr)>>;
+
+    // bot::request calls that are waiting for a reply, keyed by the serial of
+    // the request
+    std::mutex m_requests_mutex{};
+    std::unordered_map<usize, std::shared_ptr<reply_channel>> m_pending_requests{};
+
+    auto try_receive_next() -> std::optional<message>;
 
     assify<boost::asio::experimental::concurrent_channel<void(boost::system::error_code, std::string_view)>> m_completion_channel;
 
-    auto handle_message(message msg) -> boost::asio::awaitable<void>;
+    auto handle_message(message owned) -> boost::asio::awaitable<void>;
+
+    auto deliver(thing_entry const& entry, message_ptr const& msg) -> boost::asio::awaitable<void>;
+
+    auto consumer(thing& thing, mailbox& mailbox) -> boost::asio::awaitable<void>;
+
+    // puts messages that already have their serials on the bus
+    auto enqueue(std::span<message> messages, std::optional<message_priority> priority) -> boost::asio::awaitable<void>;
+
+    // either merges `msg` into the pending batch of its target or starts a new
+    // batch with it
+    auto coalesce(thing_entry const& connector, message_ptr const& msg, payloads::outgoing_message const& payload) -> boost::asio::awaitable<void>;
 
+    // sends out the batches for `targets` right away
+    auto flush_batches(std::span<const mini_kv> targets) -> boost::asio::awaitable<void>;
+
+    // sends out the batches whose window is over, or all of them
+    auto flush_batches_due(bool everything = false) -> boost::asio::awaitable<void>;
+
+    auto deliver_batch(pending_batch batch) -> boost::asio::awaitable<void>;
+
+    // payloads::add_thing is taken care of by add_thing, the message has
+    // been shared by the time these run
     template<typename Payload>
-    auto handle_message_internal(message&& msg, Payload&& payload) -> boost::asio::awaitable<anyhow::result<void>>;
+    auto handle_message_internal(message const& msg, Payload const& payload) -> boost::asio::awaitable<anyhow::result<void>>;
+
+    auto handle_message_internal(message const& msg) -> boost::asio::awaitable<anyhow::result<void>>;
 
-    auto handle_message_internal(message msg) -> boost::asio::awaitable<anyhow::result<void>>;
+    // registers a `thing` and starts its consumer and worker
+    auto add_thing(std::unique_ptr<thing> new_thing) -> boost::asio::awaitable<anyhow::result<void>>;
 };
 
 }  // namespace john
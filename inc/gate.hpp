@@ -0,0 +1,85 @@
+#pragma once
+
+#include <assio/as_expected.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace john {
+
+// something coroutines on any executor can wait on until someone else opens
+// it. starts out open.
+struct gate {
+    auto is_open() const -> bool { return m_open.load(std::memory_order_acquire); }
+
+    void close() { m_open.store(false, std::memory_order_release); }
+
+    void open() {
+        auto waiters = std::vector<waiter>{};
+
+        {
+            auto _ = std::unique_lock{m_mutex};
+            m_open.store(true, std::memory_order_release);
+            std::swap(waiters, m_waiters);
+        }
+
+        // timers aren't thread safe, cancel them where they are being waited on
+        for (auto const& [timer, executor] : waiters) {
+            boost::asio::post(executor, [timer] { timer->cancel(); });
+        }
+    }
+
+    // returns once the gate is open or the timeout has elapsed, whichever comes
+    // first. spurious returns are possible, callers are expected to re-check.
+    auto wait(std::chrono::steady_clock::duration timeout) -> boost::asio::awaitable<void> {
+        if (is_open()) {
+            co_return;
+        }
+
+        auto executor = co_await boost::asio::this_coro::executor;
+
+        // shared with open() as it might still be cancelling the timer after
+        // the timeout has woken us up
+        auto timer = std::make_shared<timer_type>(executor, timeout);
+
+        {
+            auto _ = std::unique_lock{m_mutex};
+            if (is_open()) {
+                co_return;
+            }
+
+            m_waiters.emplace_back(timer, executor);
+        }
+
+        static_cast<void>(co_await timer->async_wait());
+
+        {
+            auto _ = std::unique_lock{m_mutex};
+            std::erase_if(m_waiters, [&timer](auto const& waiter) { return waiter.m_timer == timer; });
+        }
+    }
+
+private:
+    using timer_type = assify<boost::asio::steady_timer>;
+
+    struct waiter {
+        std::shared_ptr<timer_type> m_timer;
+        boost::asio::any_io_executor m_executor;
+    };
+
+    std::atomic<bool> m_open{true};
+
+    std::mutex m_mutex{};
+    std::vector<waiter> m_waiters{};
+};
+
+}  // namespace john
@@ -3,10 +3,15 @@
 #include <alloc.hpp>
 #include <assio/as_expected.hpp>
 #include <bot.hpp>
+#include <irc/line_buffer.hpp>
 #include <irc/message.hpp>
 
 #include <boost/asio/ip/tcp.hpp>
 
+#include <atomic>
+#include <deque>
+#include <vector>
+
 namespace john::irc {
 
 struct configuration {
@@ -22,6 +27,9 @@ struct configuration {
     std::string m_realname;
 
     std::vector<std::string> m_channels;
+
+    // CRLF included, longer lines get dropped
+    usize m_max_line_length = line_buffer::default_max_line_length;
 };
 
 namespace state {
@@ -45,27 +53,34 @@ struct failure_registration {};
 using state_t = std::variant<state::disconnected, state::disconnecting, state::connected, state::registered, state::failure_connection, state::failure_registration>;
 
 struct irc_client final : thing {
-    irc_client(boost::asio::any_io_executor& executor, configuration config, usize max_message_length = 512)
+    irc_client(boost::asio::any_io_executor& executor, configuration config)
         : m_config(std::move(config))
         , m_executor(executor)
         , m_socket(m_executor)
-        , m_incoming_buffer(std::allocator<char>{}.allocate(max_message_length), max_message_length) {}
-
-    ~irc_client() {
-        std::allocator<char>{}.deallocate(m_incoming_buffer.data(), m_incoming_buffer.size());
-
-        m_incoming_buffer = {};
-    }
+        , m_incoming(m_config.m_max_line_length)
+        , m_outgoing_doorbell(m_executor, 1uz) {}
 
     irc_client(irc_client const&) = delete;
     irc_client(irc_client&&) = delete;
 
     auto get_id() const -> std::string_view override { return m_config.m_identifier; }
 
+    auto interests() const -> payload_mask override { return payload_mask_of<payloads::outgoing_message, payloads::multicast_message, payloads::exit>(); }
+
+    auto connector_ident() const -> std::optional<std::string_view> override { return m_config.m_identifier; }
+
+    // encode() would split on linefeeds, merged messages have to stay on one
+    // line to save anything. 400 leaves room for the prefix and the target
+    // within the 512 byte limit.
+    auto coalescing() const -> std::optional<coalescing_limits> override { return coalescing_limits{.m_max_size = 400uz, .m_separator = " | "}; }
+
     auto worker(bot& bot) -> boost::asio::awaitable<anyhow::result<void>> override;
 
     auto handle(john::message const& message) -> boost::asio::awaitable<anyhow::result<void>> override;
 
+    // lines waiting for the writer
+    auto get_outgoing_depth() const -> usize { return m_outgoing_depth.load(std::memory_order::relaxed); }
+
 private:
     configuration m_config;
     boost::asio::any_io_executor& m_executor;
@@ -77,19 +92,37 @@ private:
     assify<boost::asio::ip::tcp::socket> m_socket;
 
     bool m_error_cleanup = false;
-    std::span<char> m_incoming_buffer;
-    usize m_incoming_buffer_usage = 0uz;
+    line_buffer m_incoming;
+
+    // encoded lines, drained by writer(). everything touching the queue runs
+    // on our strand so it needs no lock.
+    std::deque<std::string> m_outgoing{};
+    std::atomic<usize> m_outgoing_depth{0uz};
+    assify<boost::asio::experimental::concurrent_channel<void(boost::system::error_code)>> m_outgoing_doorbell;
+
+    // bumped for every connection, a writer from an older one stops
+    usize m_connection_generation = 0uz;
 
     auto run_inner() -> boost::asio::awaitable<std::expected<void, boost::system::error_code>>;
 
-    auto message_handler(message_view const& msg) -> boost::asio::awaitable<void>;
+    // messages for the bus are appended to `to_queue` instead of being queued
+    // one by one, run_inner queues everything from one read at once
+    auto message_handler(message_view const& msg, std::vector<john::message>& to_queue) -> boost::asio::awaitable<void>;
 
     auto state_change(state_t new_state) -> boost::asio::awaitable<void>;
 
-    auto send_message(message const& msg) -> boost::asio::awaitable<void>;
+    // only queues the message, see writer()
+    void send_message(message const& msg);
+
+    // writes everything that is queued up in as few writes as possible, one
+    // per connection
+    auto writer(usize generation) -> boost::asio::awaitable<void>;
 
     auto identify_sender(message const& msg) const -> std::string;
 
+    // does nothing if the target belongs to some other connector
+    void send_to(mini_kv const& target, std::string_view content);
+
     template<typename Payload>
     auto bot_message_handler(john::message const& msg, Payload const& payload) -> boost::asio::awaitable<anyhow::result<void>>;
 };
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <error.hpp>
+#include <irc/tokenizer.hpp>
+
+#include <stuff/core/integers.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace john::irc {
+
+// a CRLF terminated line that keeps the memory it points into alive
+struct shared_line {
+    std::shared_ptr<const void> m_storage;
+
+    // includes the CRLF
+    std::string_view m_text;
+};
+
+// receive buffer that hands out complete lines without copying them
+//
+// - data is read into fixed size chunks. lines point into the chunks and
+//   share ownership of them, so a chunk is only freed (or reused) once every
+//   line in it is gone.
+// - bytes that have been handed out are never written over. once a chunk is
+//   full the incomplete line at its end (if any) is copied into a new chunk,
+//   which happens at most once per chunk.
+// - lines longer than the maximum length (CRLF included) are discarded, see
+//   next_line.
+struct line_buffer {
+    // 8191 bytes of IRCv3 tags and 512 bytes of everything else
+    inline static constexpr usize default_max_line_length = 8191uz + 512uz;
+
+    explicit line_buffer(usize max_line_length = default_max_line_length, usize chunk_size = 16uz * 1024uz)
+        : m_max_line_length(std::max(max_line_length, 2uz))
+        , m_chunk_size(std::max(chunk_size, 2uz * m_max_line_length)) {}
+
+    auto max_line_length() const -> usize { return m_max_line_length; }
+
+    // space to read into, never empty. invalidated by commit and by the next
+    // call to prepare.
+    auto prepare() -> std::span<char> {
+        if (m_chunk == nullptr) {
+            m_chunk = std::make_shared_for_overwrite<char[]>(m_chunk_size);
+        }
+
+        if (m_end == m_chunk_size) {
+            make_room();
+        }
+
+        return {m_chunk.get() + m_end, m_chunk_size - m_end};
+    }
+
+    void commit(usize bytes) { m_end += bytes; }
+
+    // forget about any partial line, lines that were handed out stay valid
+    void clear() {
+        m_chunk = nullptr;
+        m_begin = m_end = m_scanned = 0uz;
+        m_discarding = false;
+    }
+
+    // - std::nullopt once there are no complete lines left.
+    // - an error for every line that was too long. the rest of the line is
+    //   skipped over silently as it arrives.
+    auto next_line() -> anyhow::result<std::optional<shared_line>> {
+        for (;;) {
+            const auto data = std::string_view{m_chunk.get() + m_begin, m_end - m_begin};
+
+            // a CR might have been the last character the last time around
+            const auto crlf = detail::find_crlf(data, m_scanned == 0uz ? 0uz : m_scanned - 1uz);
+
+            if (crlf == std::string_view::npos) {
+                return no_complete_line(data);
+            }
+
+            const auto length = crlf + 2uz;
+            const auto text = data.substr(0, length);
+
+            m_begin += length;
+            m_scanned = 0uz;
+
+            if (std::exchange(m_discarding, false)) {
+                continue;
+            }
+
+            if (length > m_max_line_length) {
+                return _anyhow_fmt("discarded a line of {} bytes, the limit is {}", length, m_max_line_length);
+            }
+
+            return shared_line{
+              .m_storage = m_chunk,
+              .m_text = text,
+            };
+        }
+    }
+
+private:
+    usize m_max_line_length;
+    usize m_chunk_size;
+
+    std::shared_ptr<char[]> m_chunk = nullptr;
+
+    // the unconsumed bytes are [m_begin, m_end)
+    usize m_begin = 0uz;
+    usize m_end = 0uz;
+
+    // how many of the unconsumed bytes are known not to contain a CRLF
+    usize m_scanned = 0uz;
+
+    // skipping the rest of a line that is too long
+    bool m_discarding = false;
+
+    auto no_complete_line(std::string_view data) -> anyhow::result<std::optional<shared_line>> {
+        m_scanned = data.size();
+
+        if (!m_discarding && data.size() < m_max_line_length) {
+            return std::nullopt;
+        }
+
+        // keep a trailing CR around, it might be the start of the CRLF that
+        // ends the line being discarded
+        const auto keep = data.ends_with('\r') ? 1uz : 0uz;
+        m_begin = m_end - keep;
+        m_scanned = keep;
+
+        if (std::exchange(m_discarding, true)) {
+            return std::nullopt;
+        }
+
+        return _anyhow_fmt("discarding a line that is longer than {} bytes", m_max_line_length);
+    }
+
+    void make_room() {
+        const auto unconsumed = m_end - m_begin;
+
+        // nobody else is looking at this chunk, it can be reused
+        if (m_chunk.use_count() == 1) {
+            std::memmove(m_chunk.get(), m_chunk.get() + m_begin, unconsumed);
+        } else {
+            auto chunk = std::make_shared_for_overwrite<char[]>(m_chunk_size);
+            std::memcpy(chunk.get(), m_chunk.get() + m_begin, unconsumed);
+            m_chunk = std::move(chunk);
+        }
+
+        m_begin = 0uz;
+        m_end = unconsumed;
+    }
+};
+
+}  // namespace john::irc
@@ -2,11 +2,17 @@
 
 #include <error.hpp>
 #include <irc/replies.hpp>
+#include <irc/tokenizer.hpp>
 
 #include <stuff/core/integers.hpp>
 #include <stuff/core/try.hpp>
 
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <memory>
 #include <ranges>
+#include <span>
 
 namespace john::irc {
 
@@ -38,107 +44,189 @@ struct funky_iterator {
 
 }  // namespace detail
 
-// received message
+// the middle parameters of a received message. RFC 2812 allows 14 of them,
+// anything after the 14th is the trailing parameter even without a colon.
+struct param_list {
+    inline static constexpr usize capacity = 14uz;
+
+    constexpr param_list() = default;
+
+    constexpr param_list(std::initializer_list<std::string_view> params) {
+        for (auto param : params) {
+            push_back(param);
+        }
+    }
+
+    // false if the list is already full
+    constexpr auto push_back(std::string_view param) -> bool {
+        if (full()) {
+            return false;
+        }
+
+        m_items[m_size++] = param;
+        return true;
+    }
+
+    constexpr auto size() const -> usize { return m_size; }
+    constexpr auto empty() const -> bool { return m_size == 0; }
+    constexpr auto full() const -> bool { return m_size == capacity; }
+
+    constexpr auto begin() const { return m_items.begin(); }
+    constexpr auto end() const { return m_items.begin() + m_size; }
+
+    constexpr auto operator[](usize i) const -> std::string_view { return m_items[i]; }
+
+    constexpr auto span() const -> std::span<const std::string_view> { return {m_items.data(), m_size}; }
+
+    constexpr friend auto operator==(param_list const& lhs, param_list const& rhs) -> bool { return std::ranges::equal(lhs, rhs); }
+
+private:
+    std::array<std::string_view, capacity> m_items{};
+    u8 m_size = 0;
+};
+
+// received message. every view points into m_original_message, which
+// m_storage keeps alive (if it isn't static to begin with)
 struct message_view {
-    std::string m_original_message;
+    std::string_view m_original_message;
+
+    // IRCv3 message tags as received, without the leading '@'. use tag() to
+    // look one up, nothing is decoded up front.
+    std::optional<std::string_view> m_tags;
 
     std::optional<std::string_view> m_prefix_name;
     std::optional<std::string_view> m_prefix_user;
     std::optional<std::string_view> m_prefix_host;
 
     reply m_command;
-    std::string_view m_params;
+    // for commands that don't have a reply of their own
+    std::string_view m_command_text;
+    param_list m_params;
     std::optional<std::string_view> m_trailing;
 
-    static auto from_chars(std::string_view message) -> anyhow::result<message_view> {
+    std::shared_ptr<const void> m_storage = nullptr;
+
+    // a single pass over the line, see detail::token_scanner
+    static auto from_chars(std::string_view message, std::shared_ptr<const void> storage = nullptr) -> anyhow::result<message_view> {
         if (!message.ends_with("\r\n")) {
             return _anyhow("no trailing CRLF?");
         }
         message.remove_suffix(2);
 
-        auto ret = message_view{std::string{message}};
-
-        auto after_prefix = TRY(ret.init_prefix(message));
-        auto after_command = TRY(ret.init_command(after_prefix));
-        auto after_params = TRY(ret.init_params(after_command));
-        auto after_trailing = TRY(ret.init_trailing(after_params));
-        static_cast<void>(after_trailing);
-
-        return ret;
-    }
+        auto ret = message_view{.m_original_message = message, .m_storage = std::move(storage)};
+        auto tokens = detail::token_scanner{message};
 
-    auto params() const -> std::ranges::range auto {
-        using namespace std::string_view_literals;
-        return m_params |                                                      //
-               std::views::split(" "sv) |                                      //
-               std::views::filter([](auto const& v) { return !v.empty(); }) |  //
-               std::views::transform([](auto const& v) { return std::string_view(v); });
-    }
+        auto token = tokens.next();
+        if (token && token->starts_with('@')) {
+            ret.m_tags = token->substr(1);
+            token = tokens.next();
+        }
 
-private:
-    auto init_prefix(std::string_view message) -> anyhow::result<std::string_view> {
-        if (!message.starts_with(':')) {
-            return message;
+        if (token && token->starts_with(':')) {
+            ret.init_prefix(token->substr(1));
+            token = tokens.next();
         }
 
-        const auto prefix_0 = message.substr(0, std::distance(message.begin(), std::ranges::find(message, ' ')));
-        const auto prefix_name = prefix_0.substr(0, std::min(prefix_0.find('!'), prefix_0.find('@')));
+        if (!token) {
+            return _anyhow("no command in message");
+        }
 
-        const auto prefix_1 = prefix_0.substr(prefix_name.size());
-        const auto prefix_user = prefix_1.substr(0, prefix_1.find('@'));
+        ret.m_command = get_reply(*token);
+        ret.m_command_text = *token;
 
-        const auto prefix_host = prefix_1.substr(prefix_user.size());
+        while ((token = tokens.next())) {
+            if (token->starts_with(':')) {
+                ret.m_trailing = tokens.rest_from(*token).substr(1);
+                break;
+            }
 
-        m_prefix_name = prefix_name.substr(1);
+            if (ret.m_params.full()) {
+                ret.m_trailing = tokens.rest_from(*token);
+                break;
+            }
 
-        if (!prefix_user.empty()) {
-            m_prefix_user = prefix_user.substr(1);
+            ret.m_params.push_back(*token);
         }
 
-        if (!prefix_host.empty()) {
-            m_prefix_host = prefix_host.substr(1);
-        }
+        return ret;
+    }
 
-        const auto the_rest = message.substr(prefix_0.size());
-        if (the_rest.empty()) {
-            return the_rest;
+    auto params() const -> std::span<const std::string_view> { return m_params.span(); }
+
+    // the still escaped value of a tag. a tag without a value has an empty
+    // one. if a key shows up more than once the last one wins.
+    auto raw_tag(std::string_view key) const -> std::optional<std::string_view> {
+        if (!m_tags) {
+            return std::nullopt;
         }
 
-        return the_rest.substr(the_rest.find_first_not_of(' '));
-    }
+        auto ret = std::optional<std::string_view>{};
 
-    auto init_command(std::string_view after_prefix) -> anyhow::result<std::string_view> {
-        if (after_prefix.empty()) {
-            return _anyhow("no command in message");
-        }
+        for (auto rest = *m_tags; !rest.empty();) {
+            const auto tag = rest.substr(0, rest.find(';'));
+            rest.remove_prefix(std::min(tag.size() + 1, rest.size()));
+
+            const auto equals = tag.find('=');
+            if (tag.substr(0, equals) != key) {
+                continue;
+            }
 
-        const auto command_str = after_prefix.substr(0, after_prefix.find(' '));
-        const auto after_command = after_prefix.substr(command_str.size());
+            ret = equals == std::string_view::npos ? std::string_view{} : tag.substr(equals + 1);
+        }
 
-        m_command = get_reply(command_str);
-        return after_command;
+        return ret;
     }
 
-    auto init_params(std::string_view after_command) -> anyhow::result<std::string_view> {
-        const auto params_str = after_command.substr(0, after_command.find(':'));
-        const auto after_params = after_command.substr(params_str.size());
+    // the unescaped value of a tag
+    auto tag(std::string_view key) const -> std::optional<std::string> {
+        return raw_tag(key).transform([](std::string_view raw) {
+            auto ret = std::string{};
+            ret.reserve(raw.size());
+
+            for (auto i = 0uz; i < raw.size(); i++) {
+                if (raw[i] != '\\') {
+                    ret += raw[i];
+                    continue;
+                }
+
+                // a lone backslash at the end is dropped
+                if (++i == raw.size()) {
+                    break;
+                }
+
+                switch (raw[i]) {
+                    case ':': ret += ';'; break;
+                    case 's': ret += ' '; break;
+                    case 'r': ret += '\r'; break;
+                    case 'n': ret += '\n'; break;
+                    // "\\" and any other escaped character stand for themselves
+                    default: ret += raw[i]; break;
+                }
+            }
 
-        m_params = params_str;
-        return after_params;
+            return ret;
+        });
     }
 
-    auto init_trailing(std::string_view after_params) -> anyhow::result<std::string_view> {
-        if (after_params.empty()) {
-            return after_params;
-        }
+private:
+    void init_prefix(std::string_view prefix) {
+        const auto name_end = std::min(prefix.find('!'), prefix.find('@'));
+        m_prefix_name = prefix.substr(0, name_end);
 
-        if (!after_params.starts_with(':')) {
-            return _anyhow("trailing doesn't start with :");
+        if (name_end == std::string_view::npos) {
+            return;
         }
 
-        m_trailing = after_params.substr(1);
+        const auto rest = prefix.substr(name_end);
+        const auto host_start = rest.find('@');
 
-        return "";
+        if (rest.starts_with('!')) {
+            m_prefix_user = rest.substr(1, host_start == std::string_view::npos ? std::string_view::npos : host_start - 1);
+        }
+
+        if (host_start != std::string_view::npos) {
+            m_prefix_host = rest.substr(host_start + 1);
+        }
     }
 };
 
@@ -1,18 +1,108 @@
 #pragma once
 
+#include <stuff/core/integers.hpp>
+
 #include <spdlog/fmt/fmt.h>
 #include <magic_enum.hpp>
 
+#include <algorithm>
+#include <array>
+#include <ranges>
 #include <string_view>
-#include <variant>
 
 namespace john::irc {
 
+#include "./replies/commands.ipp"
 #include "./replies/replies.ipp"
 
-using reply = std::variant<int, numeric_reply, std::string_view>;
+namespace detail {
+
+#include "./replies/numeric_table.ipp"
+
+// see parse_raw.js
+constexpr auto command_hash(std::string_view command) -> u32 {
+    auto hash = command_hash_seed;
+    for (const auto c : command) {
+        hash = (hash ^ static_cast<u8>(c)) * 0x01000193u;
+    }
+    return hash;
+}
+
+}  // namespace detail
+
+// the command of a received message, fits in 16 bits and compares as such
+//
+// - [0, 1000) are numerics, known or not
+// - [1000, 1000 + the number of known commands) are known textual commands,
+//   see command_reply
+// - everything else (e.g. a command nobody told us about) is `unknown`. all
+//   unknown commands compare equal, message_view::m_command_text has the
+//   original.
+struct reply {
+    inline static constexpr u16 unknown = 0xFFFF;
+
+    constexpr reply() = default;
+
+    constexpr reply(int numeric)
+        : m_value(numeric >= 0 && numeric < detail::first_command ? static_cast<u16>(numeric) : unknown) {}
+
+    constexpr reply(numeric_reply numeric)
+        : reply(static_cast<int>(numeric)) {}
+
+    constexpr reply(command_reply command)
+        : m_value(static_cast<u16>(command)) {}
+
+    // three digits are a numeric, anything else goes through the perfect hash
+    // that parse_raw.js generated
+    constexpr reply(std::string_view command) {
+        if (command.size() == 3 && std::ranges::all_of(command, [](const char c) { return c >= '0' && c <= '9'; })) {
+            m_value = static_cast<u16>((command[0] - '0') * 100 + (command[1] - '0') * 10 + (command[2] - '0'));
+            return;
+        }
+
+        const auto slot = detail::command_slots[detail::command_hash(command) >> (32u - detail::command_slot_bits)];
+        if (slot != 0 && detail::command_names[slot - 1] == command) {
+            m_value = static_cast<u16>(detail::first_command + slot - 1);
+        }
+    }
+
+    constexpr reply(const char* command)
+        : reply(std::string_view{command}) {}
+
+    constexpr auto value() const -> u16 { return m_value; }
+
+    constexpr auto is_numeric() const -> bool { return m_value < detail::first_command; }
+    constexpr auto is_command() const -> bool { return !is_numeric() && m_value != unknown; }
+
+    // the mnemonic of a numeric or the text of a command, nullptr if neither
+    // is known
+    constexpr auto name() const -> const char* {
+        if (is_numeric()) {
+            return detail::numeric_names[m_value];
+        }
+
+        if (is_command()) {
+            return detail::command_names[m_value - detail::first_command].data();
+        }
+
+        return nullptr;
+    }
+
+    constexpr friend auto operator==(reply lhs, reply rhs) -> bool = default;
+
+private:
+    u16 m_value = unknown;
+};
+
+static_assert(sizeof(reply) == 2);
+// the generated hash has to agree with command_hash
+static_assert(std::ranges::all_of(std::views::iota(0uz, detail::command_names.size()), [](usize i) {
+    return reply{detail::command_names[i]}.value() == detail::first_command + i;
+}));
+static_assert(reply{"433"} == numeric_reply::ERR_NICKNAMEINUSE);
+static_assert(reply{"PRIVMSGX"} == reply{});
 
-auto get_reply(std::string_view raw_reply) -> reply;
+constexpr auto get_reply(std::string_view raw_reply) -> reply { return reply{raw_reply}; }
 
 }  // namespace john::irc
 
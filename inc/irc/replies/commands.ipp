@@ -0,0 +1,68 @@
+enum class command_reply : u16 {
+    PASS = 1000,
+    NICK = 1001,
+    USER = 1002,
+    OPER = 1003,
+    MODE = 1004,
+    SERVICE = 1005,
+    QUIT = 1006,
+    SQUIT = 1007,
+    JOIN = 1008,
+    PART = 1009,
+    TOPIC = 1010,
+    NAMES = 1011,
+    LIST = 1012,
+    INVITE = 1013,
+    KICK = 1014,
+    PRIVMSG = 1015,
+    NOTICE = 1016,
+    MOTD = 1017,
+    LUSERS = 1018,
+    VERSION = 1019,
+    STATS = 1020,
+    LINKS = 1021,
+    TIME = 1022,
+    CONNECT = 1023,
+    TRACE = 1024,
+    ADMIN = 1025,
+    INFO = 1026,
+    SERVLIST = 1027,
+    SQUERY = 1028,
+    WHO = 1029,
+    WHOIS = 1030,
+    WHOWAS = 1031,
+    KILL = 1032,
+    PING = 1033,
+    PONG = 1034,
+    ERROR = 1035,
+    AWAY = 1036,
+    REHASH = 1037,
+    DIE = 1038,
+    RESTART = 1039,
+    SUMMON = 1040,
+    USERS = 1041,
+    WALLOPS = 1042,
+    USERHOST = 1043,
+    ISON = 1044,
+    CAP = 1045,
+    AUTHENTICATE = 1046,
+    ACCOUNT = 1047,
+    CHGHOST = 1048,
+    SETNAME = 1049,
+    BATCH = 1050,
+    TAGMSG = 1051,
+};
+
+namespace detail {
+
+static constexpr u16 first_command = 1000;
+
+static constexpr std::array<std::string_view, 52> command_names{"PASS", "NICK", "USER", "OPER", "MODE", "SERVICE", "QUIT", "SQUIT", "JOIN", "PART", "TOPIC", "NAMES", "LIST", "INVITE", "KICK", "PRIVMSG", "NOTICE", "MOTD", "LUSERS", "VERSION", "STATS", "LINKS", "TIME", "CONNECT", "TRACE", "ADMIN", "INFO", "SERVLIST", "SQUERY", "WHO", "WHOIS", "WHOWAS", "KILL", "PING", "PONG", "ERROR", "AWAY", "REHASH", "DIE", "RESTART", "SUMMON", "USERS", "WALLOPS", "USERHOST", "ISON", "CAP", "AUTHENTICATE", "ACCOUNT", "CHGHOST", "SETNAME", "BATCH", "TAGMSG"};
+
+static constexpr u32 command_hash_seed = 5047;
+static constexpr u32 command_slot_bits = 7;
+
+// 1 + the index into command_names, 0 for empty slots
+static constexpr std::array<u8, 128> command_slots{31, 0, 49, 33, 0, 14, 20, 18, 0, 0, 0, 0, 30, 45, 41, 0, 0, 29, 0, 0, 0, 0, 0, 8, 0, 34, 0, 24, 0, 47, 0, 0, 0, 0, 0, 35, 0, 0, 43, 21, 0, 0, 0, 0, 32, 0, 0, 0, 48, 0, 28, 0, 37, 0, 0, 5, 0, 0, 0, 3, 51, 10, 40, 12, 0, 0, 0, 27, 46, 0, 0, 0, 16, 0, 4, 42, 23, 0, 13, 0, 0, 0, 6, 0, 0, 7, 0, 0, 19, 44, 52, 0, 0, 36, 1, 17, 0, 39, 38, 0, 0, 9, 0, 0, 50, 11, 0, 0, 0, 0, 26, 0, 25, 2, 0, 0, 0, 0, 15, 0, 0, 0, 0, 0, 0, 0, 0, 22};
+
+}  // namespace detail
@@ -0,0 +1,102 @@
+static constexpr std::array<const char*, 1000> numeric_names{
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    "RPL_TRACELINK", "RPL_TRACECONNECTING", "RPL_TRACEHANDSHAKE", "RPL_TRACEUNKNOWN", "RPL_TRACEOPERATOR", "RPL_TRACEUSER", "RPL_TRACESERVER", nullptr, "RPL_TRACENEWTYPE", nullptr,
+    nullptr, "RPL_STATSLINKINFO", "RPL_STATSCOMMANDS", "RPL_STATSCLINE", "RPL_STATSNLINE", "RPL_STATSILINE", "RPL_STATSKLINE", nullptr, "RPL_STATSYLINE", "RPL_ENDOFSTATS",
+    nullptr, "RPL_UMODEIS", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "RPL_STATSLLINE", "RPL_STATSUPTIME", "RPL_STATSOLINE", "RPL_STATSHLINE", nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "RPL_LUSERCLIENT", "RPL_LUSEROP", "RPL_LUSERUNKNOWN", "RPL_LUSERCHANNELS", "RPL_LUSERME", "RPL_ADMINME", "RPL_ADMINLOC1", "RPL_ADMINLOC2", "RPL_ADMINEMAIL",
+    nullptr, "RPL_TRACELOG", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    "RPL_NONE", "RPL_AWAY", "RPL_USERHOST", "RPL_ISON", nullptr, "RPL_UNAWAY", "RPL_NOWAWAY", nullptr, nullptr, nullptr,
+    nullptr, "RPL_WHOISUSER", "RPL_WHOISSERVER", "RPL_WHOISOPERATOR", "RPL_WHOWASUSER", "RPL_ENDOFWHO", nullptr, "RPL_WHOISIDLE", "RPL_ENDOFWHOIS", "RPL_WHOISCHANNELS",
+    nullptr, "RPL_LISTSTART", "RPL_LIST", "RPL_LISTEND", "RPL_CHANNELMODEIS", nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "RPL_NOTOPIC", "RPL_TOPIC", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "RPL_INVITING", "RPL_SUMMONING", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "RPL_VERSION", "RPL_WHOREPLY", "RPL_NAMREPLY", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, "RPL_LINKS", "RPL_ENDOFLINKS", "RPL_ENDOFNAMES", "RPL_BANLIST", "RPL_ENDOFBANLIST", "RPL_ENDOFWHOWAS",
+    nullptr, "RPL_INFO", "RPL_MOTD", nullptr, "RPL_ENDOFINFO", "RPL_MOTDSTART", "RPL_ENDOFMOTD", nullptr, nullptr, nullptr,
+    nullptr, "RPL_YOUREOPER", "RPL_REHASHING", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "RPL_TIME", "RPL_USERSSTART", "RPL_USERS", "RPL_ENDOFUSERS", "RPL_NOUSERS", nullptr, nullptr, nullptr, nullptr,
+    nullptr, "ERR_NOSUCHNICK", "ERR_NOSUCHSERVER", "ERR_NOSUCHCHANNEL", "ERR_CANNOTSENDTOCHAN", "ERR_TOOMANYCHANNELS", "ERR_WASNOSUCHNICK", "ERR_TOOMANYTARGETS", nullptr, "ERR_NOORIGIN",
+    nullptr, "ERR_NORECIPIENT", "ERR_NOTEXTTOSEND", "ERR_NOTOPLEVEL", "ERR_WILDTOPLEVEL", nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "ERR_UNKNOWNCOMMAND", "ERR_NOMOTD", "ERR_NOADMININFO", "ERR_FILEERROR", nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "ERR_NONICKNAMEGIVEN", "ERR_ERRONEUSNICKNAME", "ERR_NICKNAMEINUSE", nullptr, nullptr, "ERR_NICKCOLLISION", nullptr, nullptr, nullptr,
+    nullptr, "ERR_USERNOTINCHANNEL", "ERR_NOTONCHANNEL", "ERR_USERONCHANNEL", "ERR_NOLOGIN", "ERR_SUMMONDISABLED", "ERR_USERSDISABLED", nullptr, nullptr, nullptr,
+    nullptr, "ERR_NOTREGISTERED", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "ERR_NEEDMOREPARAMS", "ERR_ALREADYREGISTRED", "ERR_NOPERMFORHOST", "ERR_PASSWDMISMATCH", "ERR_YOUREBANNEDCREEP", nullptr, "ERR_KEYSET", nullptr, nullptr,
+    nullptr, "ERR_CHANNELISFULL", "ERR_UNKNOWNMODE", "ERR_INVITEONLYCHAN", "ERR_BANNEDFROMCHAN", "ERR_BADCHANNELKEY", nullptr, nullptr, nullptr, nullptr,
+    nullptr, "ERR_NOPRIVILEGES", "ERR_CHANOPRIVSNEEDED", "ERR_CANTKILLSERVER", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "ERR_NOOPERHOST", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, "ERR_UMODEUNKNOWNFLAG", "ERR_USERSDONTMATCH", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
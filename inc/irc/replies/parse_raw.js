@@ -41,5 +41,67 @@ const enum_entries = replies.map(v => {
 });
 
 require("fs").writeFileSync("replies.ipp", `enum class numeric_reply : int {\n\n${enum_entries.join("")}};`);
-require("fs").writeFileSync("reply_list.ipp", `static constexpr std::pair<int, const char*> valid_replies[] = { ${replies.sort((a, b)=>a.code-b.code).map(v=>`{${v.code}, "${v.mnemonic}"}`).join(", ")} };`)
+
+// direct-index table of every numeric's name, nullptr for unknown numerics
+const numeric_names = Array(1000).fill("nullptr");
+replies.forEach(v => { numeric_names[v.code] = `"${v.mnemonic}"`; });
+
+const numeric_rows = [];
+for (let i = 0; i < numeric_names.length; i += 10) {
+  numeric_rows.push(`    ${numeric_names.slice(i, i + 10).join(", ")},`);
+}
+
+require("fs").writeFileSync("numeric_table.ipp", `static constexpr std::array<const char*, 1000> numeric_names{\n${numeric_rows.join("\n")}\n};\n`);
+
+// textual commands, numbered after the numerics so that every reply fits a u16
+const commands = require("fs").readFileSync("commands_raw", "utf-8").split("\n").map(v => v.trim()).filter(v => v.length != 0);
+const first_command = 1000;
+
+// FNV-1a with a seed instead of the offset basis, has to match command_hash
+const command_hash = (str, seed) => {
+  let hash = seed >>> 0;
+  for (let i = 0; i < str.length; i++) {
+    hash = Math.imul(hash ^ str.charCodeAt(i), 0x01000193) >>> 0;
+  }
+  return hash;
+};
+
+// the smallest power of two table with at least twice as many slots as there
+// are commands, and the first seed that puts every command in its own slot.
+// the slot comes from the top bits, the low bits of a multiplicative hash
+// only depend on the low bits of the seed.
+let slot_bits = 1;
+while ((1 << slot_bits) < commands.length * 2) { slot_bits++; }
+const slot_count = 1 << slot_bits;
+
+let seed = 0;
+let slots;
+for (;; seed++) {
+  slots = Array(slot_count).fill(0);
+  if (commands.every((v, i) => {
+    const slot = command_hash(v, seed) >>> (32 - slot_bits);
+    if (slots[slot] != 0) { return false; }
+    slots[slot] = i + 1;
+    return true;
+  })) { break; }
+}
+
+const command_entries = commands.map((v, i) => `    ${v} = ${first_command + i},\n`);
+
+require("fs").writeFileSync("commands.ipp", `enum class command_reply : u16 {\n${command_entries.join("")}};
+
+namespace detail {
+
+static constexpr u16 first_command = ${first_command};
+
+static constexpr std::array<std::string_view, ${commands.length}> command_names{${commands.map(v => `"${v}"`).join(", ")}};
+
+static constexpr u32 command_hash_seed = ${seed};
+static constexpr u32 command_slot_bits = ${slot_bits};
+
+// 1 + the index into command_names, 0 for empty slots
+static constexpr std::array<u8, ${slot_count}> command_slots{${slots.join(", ")}};
+
+}  // namespace detail
+`);
 
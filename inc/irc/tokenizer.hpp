@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stuff/core/integers.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#    include <immintrin.h>
+#endif
+
+namespace john::irc::detail {
+
+// the widest instruction set the build targets is picked at compile time,
+// build with -mavx2 (or -march=native) to get the AVX2 path
+
+// a block of up to block_size bytes of input. shorter blocks (at the end of
+// the input) are padded with NULs, which nothing searches for.
+struct simd_block {
+#if defined(__AVX2__)
+    inline static constexpr usize block_size = 32uz;
+
+    simd_block(const char* data, usize size) {
+        if (size == block_size) {
+            m_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        } else {
+            alignas(32) char padded[block_size]{};
+            std::memcpy(padded, data, size);
+            m_block = _mm256_load_si256(reinterpret_cast<const __m256i*>(padded));
+        }
+    }
+
+    // bit i is set if byte i is `c`
+    auto eq(char c) const -> u64 { return static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(m_block, _mm256_set1_epi8(c)))); }
+
+private:
+    __m256i m_block;
+#elif defined(__SSE2__)
+    inline static constexpr usize block_size = 16uz;
+
+    simd_block(const char* data, usize size) {
+        if (size == block_size) {
+            m_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        } else {
+            alignas(16) char padded[block_size]{};
+            std::memcpy(padded, data, size);
+            m_block = _mm_load_si128(reinterpret_cast<const __m128i*>(padded));
+        }
+    }
+
+    auto eq(char c) const -> u64 { return static_cast<u16>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_block, _mm_set1_epi8(c)))); }
+
+private:
+    __m128i m_block;
+#else
+    inline static constexpr usize block_size = 64uz;
+
+    simd_block(const char* data, usize size)
+        : m_data(data)
+        , m_size(size) {}
+
+    auto eq(char c) const -> u64 {
+        auto ret = u64{0};
+        for (auto i = 0uz; i < m_size; i++) {
+            ret |= static_cast<u64>(m_data[i] == c) << i;
+        }
+        return ret;
+    }
+
+private:
+    const char* m_data;
+    usize m_size;
+#endif
+};
+
+// the bits that belong to the first `size` bytes of a block
+constexpr auto valid_bits(usize size) -> u64 { return size >= 64uz ? ~u64{0} : (u64{1} << size) - 1; }
+
+// offset of the first CRLF at or after `from`, std::string_view::npos if
+// there is none
+inline auto find_crlf(std::string_view data, usize from = 0uz) -> usize {
+    constexpr auto block_size = simd_block::block_size;
+
+    for (auto base = from; base < data.size(); base += block_size) {
+        const auto size = std::min(block_size, data.size() - base);
+        const auto block = simd_block{data.data() + base, size};
+
+        const auto carriage_returns = block.eq('\r');
+
+        if (const auto hits = carriage_returns & (block.eq('\n') >> 1); hits != 0) {
+            return base + std::countr_zero(hits);
+        }
+
+        // the LF might be the first byte of the next block
+        const auto last = base + block_size - 1uz;
+        if (((carriage_returns >> (block_size - 1uz)) & 1u) != 0u && last + 1uz < data.size() && data[last + 1uz] == '\n') {
+            return last;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+// splits a line into runs of non-space characters, looking at every byte
+// once and a block at a time
+struct token_scanner {
+    explicit token_scanner(std::string_view line)
+        : m_line(line) {
+        load();
+    }
+
+    // std::nullopt at the end of the line
+    auto next() -> std::optional<std::string_view> {
+        const auto begin = find(false);
+        if (begin == m_line.size()) {
+            return std::nullopt;
+        }
+
+        m_pos = begin;
+        const auto end = find(true);
+        m_pos = end;
+
+        return m_line.substr(begin, end - begin);
+    }
+
+    // everything from `token` (which must have come from next) onwards
+    auto rest_from(std::string_view token) const -> std::string_view { return m_line.substr(static_cast<usize>(token.data() - m_line.data())); }
+
+private:
+    std::string_view m_line;
+
+    // start of the current block and where to continue from within it
+    usize m_base = 0uz;
+    usize m_pos = 0uz;
+
+    u64 m_spaces = 0;
+    u64 m_valid = 0;
+
+    void load() {
+        if (m_base >= m_line.size()) {
+            return;
+        }
+
+        const auto size = std::min(simd_block::block_size, m_line.size() - m_base);
+        m_spaces = simd_block{m_line.data() + m_base, size}.eq(' ');
+        m_valid = valid_bits(size);
+    }
+
+    // the first offset at or after m_pos that is (or isn't) a space, the size
+    // of the line if there is none
+    auto find(bool space) -> usize {
+        for (;;) {
+            if (m_base >= m_line.size()) {
+                return m_line.size();
+            }
+
+            const auto candidates = (space ? m_spaces : ~m_spaces) & m_valid & (~u64{0} << (m_pos - m_base));
+            if (candidates != 0) {
+                return m_base + std::countr_zero(candidates);
+            }
+
+            m_base += simd_block::block_size;
+            m_pos = m_base;
+            load();
+        }
+    }
+};
+
+}  // namespace john::irc::detail
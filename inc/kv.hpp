@@ -8,6 +8,7 @@
 #include <ranges>
 #include <string>
 #include <string_view>
+#include <utility>
 
 namespace john {
 
@@ -146,8 +147,14 @@ struct basic_mini_kv {
     // complexity: linear
     constexpr auto contains(std::string_view key) const -> bool { return (*this)[key]; }
 
+    // the order of the entries doesn't matter
+    //
     // complexity: quadratic
     constexpr auto operator==(basic_mini_kv const& other) const noexcept -> bool {
+        if (size() != other.size()) {
+            return false;
+        }
+
         for (auto const& [k, v] : *this) {
             if (auto v_other = other[k]; !v_other || *v_other != v) {
                 return false;
@@ -161,79 +168,64 @@ struct basic_mini_kv {
         return !operator==(other);
     }
 
+    // the inverse of serialize, escapes are undone
+    //
+    // an entry without a colon is a value with an empty key. a backslash at
+    // the very end escapes nothing and is kept as is.
     static constexpr auto deserialize(std::string_view str, Allocator allocator = {}) -> basic_mini_kv {
-        using namespace std::string_view_literals;
-
-        // clang-format off
-        auto view =
-            std::views::zip(
-                std::views::iota(0uz),
-                str
-                | std::views::chunk_by([count = 0uz](const auto lhs, const auto rhs) mutable {
-                    count = (count + (lhs == '\\')) * (lhs == '\\');
-                    return !(lhs != '\\' && rhs == ';') || ((count % 2) == 1);
-                })
-            )
-            | std::views::transform([](auto const& pair) {
-                auto const& [idx, str] = pair;
-                return idx == 0
-                      ? std::string_view(str)
-                      : std::string_view(str).substr(1);
-            })
-            | std::views::transform([](auto const& str) {
-                // reversing and whatnot screws up the mutable lambda approach
-                // too bad
-                /*auto stuff = str
-                    | std::views::chunk_by([count = 0uz](const auto lhs, const auto rhs) mutable {
-                        count = (count + (lhs == '\\')) * (lhs == '\\');
-                        return !(lhs != '\\' && rhs == ':') || ((count % 2) == 1);
-                    })
-                    | std::views::transform([](auto const& v) { return std::string_view(v); })
-                    | std::views::take(2)
-                    | std::views::reverse;
-
-                auto arr = std::array<std::string_view, 2> {};
-                std::ranges::copy(stuff, arr.rbegin()); // funny approach if you ask me
-
-                return std::pair{arr[0], arr[1]};*/
-
-                auto split = 0uz;
-                for (auto escape_count = 0uz; split < str.size(); split++) {
-                    const auto c = str[split];
-                    const auto is_escape = c == '\\';
-                    const auto is_split = c == ':';
-
-                    if (is_split && (escape_count % 2) == 0) {
-                        break;
-                    }
-
-                    escape_count = (escape_count + is_escape) * is_escape;
-                }
-
-                if (split == str.size()) {
-                    return std::pair{""sv, str};
-                } else {
-                    const auto lhs = str.substr(0, split);
-                    const auto rhs = str.substr(split + 1);
-
-                    return std::pair{lhs, rhs};
-                }
-            });
-        // clang-format on
-
         auto ret = basic_mini_kv{allocator};
+        if (str.empty()) {
+            return ret;
+        }
 
-        for (auto const& [k, v] : view) {
-            ret.push_back(k, v);
+        // the key is read into `value` too, until the first colon
+        auto key = std::string{};
+        auto value = std::string{};
+        auto seen_colon = false;
+        auto escaped = false;
+
+        for (const auto c : str) {
+            if (std::exchange(escaped, false)) {
+                value.push_back(c);
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == ';') {
+                ret.push_back(key, value);
+                key.clear();
+                value.clear();
+                seen_colon = false;
+            } else if (c == ':' && !seen_colon) {
+                key = std::exchange(value, std::string{});
+                seen_colon = true;
+            } else {
+                value.push_back(c);
+            }
         }
 
+        if (escaped) {
+            value.push_back('\\');
+        }
+
+        ret.push_back(key, value);
+
         return ret;
     }
 
-    constexpr auto serialize() const -> std::string {
+    // writes the serialized form into `out`, replacing what was there. lets
+    // callers that serialize often keep reusing one buffer.
+    //
+    // the order of the entries is kept, two kvs that only differ in the order
+    // of their entries serialize differently.
+    constexpr void serialize_to(std::string& out) const {
+        const auto when = [](char c) { return c == ':' || c == ';' || c == '\\'; };
+
+        out.clear();
+        if (empty()) {
+            return;
+        }
+
         auto required_bytes = 0uz;
         for (auto const& [k, v] : *this) {
-            const auto when = [](char c) { return c == ':' || c == ';' || c == '\\'; };
             required_bytes += k.size() + std::ranges::count_if(k, when);  // key
             required_bytes += 1uz;                                        // colon
             required_bytes += v.size() + std::ranges::count_if(v, when);  // value
@@ -241,32 +233,32 @@ struct basic_mini_kv {
         }
         required_bytes -= 1uz;  // last semicolon
 
-        auto ret = std::string(required_bytes, ';');
-        auto ret_it = ret.begin();
+        out.reserve(required_bytes);
 
-        const auto escaped_copy = [](std::string_view str, auto iter) {
-            for (char c : str) {
-                auto escapes = std::array<char, 3>{':', ';', '\\'};
-                if (std::ranges::find(escapes, c) != std::ranges::end(escapes)) {
-                    *iter++ = '\\';
+        const auto escaped_append = [&](std::string_view str) {
+            for (const auto c : str) {
+                if (when(c)) {
+                    out.push_back('\\');
                 }
-                *iter++ = c;
+                out.push_back(c);
             }
-
-            return iter;
         };
 
         for (auto first = true; auto const& [k, v] : *this) {
             if (!first) {
-                *ret_it++ = ';';
+                out.push_back(';');
             }
             first = false;
 
-            ret_it = escaped_copy(k, ret_it);
-            *ret_it++ = ':';
-            ret_it = escaped_copy(v, ret_it);
+            escaped_append(k);
+            out.push_back(':');
+            escaped_append(v);
         }
+    }
 
+    constexpr auto serialize() const -> std::string {
+        auto ret = std::string{};
+        serialize_to(ret);
         return ret;
     }
 
@@ -282,13 +274,14 @@ using mini_kv = basic_mini_kv<>;
 template<typename Allocator>
 struct std::hash<john::basic_mini_kv<Allocator>> {
     constexpr auto operator()(john::basic_mini_kv<Allocator> const& kv) const -> usize {
+        // summed so that the order of the entries doesn't matter, like with
+        // operator==
         auto ret = 0uz;
 
         for (auto const& [k, v] : kv) {
-            ret = stf::hash_combine(ret, std::hash<std::string_view>{}(k));
-            ret = stf::hash_combine(ret, std::hash<std::string_view>{}(k));
+            ret += stf::hash_combine(std::hash<std::string_view>{}(k), std::hash<std::string_view>{}(v));
         }
 
-        return ret;
+        return stf::hash_combine(ret, kv.size());
     }
 };
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <kv.hpp>
+
+#include <stuff/core/integers.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace john {
+
+// maps serialized mini_kv patterns to values
+//
+// - a pattern is what mini_kv::serialize would produce for the kvs it is
+//   supposed to match (e.g. `ident:irc_0;target:#chan`).
+// - a pattern ending with an unescaped `*` matches every kv whose serialized
+//   form starts with the rest of the pattern (e.g. `ident:irc_0;target:#*`
+//   matches every channel of irc_0). a trailing `\*` matches a literal
+//   asterisk instead.
+// - exact and wildcard patterns live in the same character trie so a lookup is
+//   a single walk over the serialized kv, which is never materialized.
+template<typename T>
+struct kv_pattern_map {
+    // returns false if the pattern was already mapped to an equal value
+    auto insert(std::string_view pattern, T value) -> bool {
+        const auto wildcard = is_wildcard(pattern);
+
+        // serialize doesn't escape asterisks, a trailing `\*` is stored as a
+        // plain `*` so that it can match
+        const auto literal_asterisk = !wildcard && pattern.ends_with('*');
+
+        if (wildcard) {
+            pattern.remove_suffix(1);
+        } else if (literal_asterisk) {
+            pattern.remove_suffix(2);
+        }
+
+        auto node = 0uz;
+        for (const auto c : pattern) {
+            node = child_or_insert(node, c);
+        }
+
+        if (literal_asterisk) {
+            node = child_or_insert(node, '*');
+        }
+
+        auto& values = wildcard ? m_nodes[node].m_prefix_values : m_nodes[node].m_exact_values;
+        if (std::ranges::find(values, value) != values.end()) {
+            return false;
+        }
+
+        values.emplace_back(std::move(value));
+        m_size++;
+
+        return true;
+    }
+
+    // appends pointers to the values of every matching pattern to `out`, each
+    // distinct value only once. `out` is meant to be reused across calls so
+    // that lookups don't allocate.
+    void match(mini_kv const& kv, std::vector<T const*>& out) const {
+        if (empty()) {
+            return;
+        }
+
+        const auto append = [&out](std::vector<T> const& values) {
+            for (auto const& value : values) {
+                if (std::ranges::find_if(out, [&value](T const* other) { return *other == value; }) == out.end()) {
+                    out.emplace_back(&value);
+                }
+            }
+        };
+
+        auto node = 0uz;
+        auto fell_off = false;
+
+        walk(kv, [&](char c) {
+            append(m_nodes[node].m_prefix_values);
+
+            const auto next = child_of(node, c);
+            if (!next) {
+                fell_off = true;
+                return false;
+            }
+
+            node = *next;
+            return true;
+        });
+
+        if (fell_off) {
+            return;
+        }
+
+        // a wildcard pattern matches the empty suffix too
+        append(m_nodes[node].m_prefix_values);
+        append(m_nodes[node].m_exact_values);
+    }
+
+    auto size() const -> usize { return m_size; }
+    auto empty() const -> bool { return m_size == 0; }
+
+    void clear() {
+        m_nodes.resize(1);
+        m_nodes.front() = node{};
+        m_size = 0;
+    }
+
+private:
+    struct node {
+        // kept sorted by the character
+        std::vector<std::pair<char, u32>> m_children{};
+
+        std::vector<T> m_exact_values{};
+        std::vector<T> m_prefix_values{};
+    };
+
+    std::vector<node> m_nodes{node{}};
+    usize m_size = 0uz;
+
+    static auto is_wildcard(std::string_view pattern) -> bool {
+        if (!pattern.ends_with('*')) {
+            return false;
+        }
+
+        // `\*` is a literal asterisk, `\\*` is an escaped backslash followed
+        // by a wildcard
+        const auto before = pattern.substr(0, pattern.size() - 1);
+        const auto backslashes = before.size() - std::min(before.size(), before.find_last_not_of('\\') + 1);
+
+        return backslashes % 2 == 0;
+    }
+
+    auto child_of(usize node, char c) const -> std::optional<usize> {
+        auto const& children = m_nodes[node].m_children;
+        const auto it = std::ranges::lower_bound(children, c, {}, &std::pair<char, u32>::first);
+
+        if (it == children.end() || it->first != c) {
+            return std::nullopt;
+        }
+
+        return it->second;
+    }
+
+    auto child_or_insert(usize node, char c) -> usize {
+        if (auto child = child_of(node, c); child) {
+            return *child;
+        }
+
+        const auto new_node = m_nodes.size();
+        m_nodes.emplace_back();
+
+        auto& children = m_nodes[node].m_children;
+        const auto it = std::ranges::lower_bound(children, c, {}, &std::pair<char, u32>::first);
+        children.emplace(it, c, static_cast<u32>(new_node));
+
+        return new_node;
+    }
+
+    // feeds the characters of `kv.serialize()` to `fun` until it returns false
+    template<typename Fun>
+    static void walk(mini_kv const& kv, Fun&& fun) {
+        const auto escaped = [&fun](std::string_view str) {
+            for (const auto c : str) {
+                if ((c == ':' || c == ';' || c == '\\') && !fun('\\')) {
+                    return false;
+                }
+
+                if (!fun(c)) {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        for (auto first = true; auto const& [k, v] : kv) {
+            if (!first && !fun(';')) {
+                return;
+            }
+            first = false;
+
+            if (!escaped(k) || !fun(':') || !escaped(v)) {
+                return;
+            }
+        }
+    }
+};
+
+}  // namespace john
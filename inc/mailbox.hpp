@@ -0,0 +1,140 @@
+#pragma once
+
+#include <assio/as_expected.hpp>
+
+#include <stuff/core/integers.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/experimental/concurrent_channel.hpp>
+
+#include <atomic>
+#include <optional>
+
+namespace john {
+
+enum class overflow_policy {
+    // suspend the sender until there is room
+    block,
+    // evict the oldest queued item to make room
+    drop_oldest,
+    // discard the item that is being pushed
+    drop_newest,
+};
+
+struct mailbox_configuration {
+    usize m_capacity = 256uz;
+    overflow_policy m_policy = overflow_policy::block;
+};
+
+struct mailbox_stats {
+    usize m_depth;
+    usize m_max_depth;
+    usize m_delivered;
+    usize m_dropped;
+};
+
+// bounded, multi-producer single-consumer queue
+//
+// T must be default constructible and cheap to copy, a default constructed T
+// is used as the end-of-stream marker.
+template<typename T>
+struct basic_mailbox {
+    basic_mailbox(boost::asio::any_io_executor const& executor, mailbox_configuration config)
+        : m_config(config)
+        , m_channel(executor, std::max(config.m_capacity, 1uz)) {}
+
+    basic_mailbox(basic_mailbox const&) = delete;
+    basic_mailbox(basic_mailbox&&) = delete;
+
+    // returns false if the item (or, with drop_oldest, another one) had to be
+    // dropped
+    auto push(T item) -> boost::asio::awaitable<bool> {
+        // the depth is bumped before the item becomes visible so that the
+        // consumer can never observe (and decrement) it first
+        note_pushed();
+
+        if (m_channel.try_send(boost::system::error_code{}, item)) {
+            co_return true;
+        }
+
+        switch (m_config.m_policy) {
+            case overflow_policy::block: {
+                if (auto res = co_await m_channel.async_send(boost::system::error_code{}, std::move(item)); !res) {
+                    break;
+                }
+
+                co_return true;
+            }
+
+            case overflow_policy::drop_oldest: {
+                for (auto evicted_any = false;;) {
+                    if (m_channel.try_receive([](boost::system::error_code, T) {})) {
+                        evicted_any = true;
+                        m_depth.fetch_sub(1uz, std::memory_order_relaxed);
+                        m_dropped.fetch_add(1uz, std::memory_order_relaxed);
+                    }
+
+                    if (m_channel.try_send(boost::system::error_code{}, item)) {
+                        co_return !evicted_any;
+                    }
+                }
+            }
+
+            case overflow_policy::drop_newest: break;
+        }
+
+        m_depth.fetch_sub(1uz, std::memory_order_relaxed);
+        m_dropped.fetch_add(1uz, std::memory_order_relaxed);
+        co_return false;
+    }
+
+    // std::nullopt once the end-of-stream marker is reached
+    auto pop() -> boost::asio::awaitable<std::optional<T>> {
+        auto res = co_await m_channel.async_receive();
+        if (!res || *res == T{}) {
+            co_return std::nullopt;
+        }
+
+        m_depth.fetch_sub(1uz, std::memory_order_relaxed);
+        m_delivered.fetch_add(1uz, std::memory_order_relaxed);
+
+        co_return std::move(*res);
+    }
+
+    // queues the end-of-stream marker behind everything that has already been
+    // pushed, regardless of the overflow policy
+    auto close() -> boost::asio::awaitable<void> {
+        co_await m_channel.async_send(boost::system::error_code{}, T{});  //
+    }
+
+    auto stats() const -> mailbox_stats {
+        return {
+          .m_depth = m_depth.load(std::memory_order_relaxed),
+          .m_max_depth = m_max_depth.load(std::memory_order_relaxed),
+          .m_delivered = m_delivered.load(std::memory_order_relaxed),
+          .m_dropped = m_dropped.load(std::memory_order_relaxed),
+        };
+    }
+
+    auto config() const -> mailbox_configuration const& { return m_config; }
+
+private:
+    mailbox_configuration m_config;
+
+    assify<boost::asio::experimental::concurrent_channel<void(boost::system::error_code, T)>> m_channel;
+
+    std::atomic<usize> m_depth{0uz};
+    std::atomic<usize> m_max_depth{0uz};
+    std::atomic<usize> m_delivered{0uz};
+    std::atomic<usize> m_dropped{0uz};
+
+    void note_pushed() {
+        const auto depth = m_depth.fetch_add(1uz, std::memory_order_relaxed) + 1uz;
+
+        auto max_depth = m_max_depth.load(std::memory_order_relaxed);
+        while (depth > max_depth && !m_max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {}
+    }
+};
+
+}  // namespace john
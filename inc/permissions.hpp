@@ -0,0 +1,69 @@
+#pragma once
+
+#include <error.hpp>
+#include <kv.hpp>
+
+#include <sqlite/async.hpp>
+
+#include <boost/asio/awaitable.hpp>
+
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace john {
+
+enum class user_level : int {
+    regular = 0,
+    admin = 1,
+    op = 2,
+};
+
+struct string_hash {
+    using is_transparent = void;
+    auto operator()(std::string_view str) const -> usize { return std::hash<std::string_view>{}(str); }
+};
+
+// what a single user is allowed to do
+struct permission_set {
+    user_level m_level = user_level::regular;
+
+    // commands that this user may run regardless of their level
+    std::unordered_set<std::string, string_hash, std::equal_to<>> m_grants;
+};
+
+// an in-memory copy of the user_levels and command_grants tables
+//
+// - users are keyed by their serialized mini_kv with the entries sorted by
+//   key, the same string the tables store. the order a connector or an op
+//   puts the entries in doesn't matter.
+// - the tables are read by reload(). set_level, grant and revoke write on the
+//   writer connection and update the cache in the same go, so that concurrent
+//   changes end up in the cache in the order they hit the database.
+// - checks don't touch the database. the key is built in buffers that every
+//   thread reuses, so they don't allocate either once those have grown.
+struct permission_table {
+    auto reload(sqlite::connection& db) -> anyhow::result<void>;
+
+    auto level_of(mini_kv const& user) const -> user_level;
+
+    auto may_run(mini_kv const& user, std::string_view command, user_level min_level) const -> bool;
+
+    auto set_level(sqlite::async_database& db, mini_kv const& user, user_level level) -> boost::asio::awaitable<anyhow::result<void>>;
+
+    auto grant(sqlite::async_database& db, mini_kv const& user, std::string_view command) -> boost::asio::awaitable<anyhow::result<void>>;
+
+    auto revoke(sqlite::async_database& db, mini_kv const& user, std::string_view command) -> boost::asio::awaitable<anyhow::result<void>>;
+
+private:
+    mutable std::shared_mutex m_mutex{};
+    std::unordered_map<std::string, permission_set, string_hash, std::equal_to<>> m_users{};
+
+    // the serialized form of `user` with its entries sorted, valid until the
+    // next call on this thread
+    static auto key_of(mini_kv const& user) -> std::string_view;
+};
+
+}  // namespace john
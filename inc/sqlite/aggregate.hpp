@@ -35,7 +35,7 @@ private:
 }  // namespace detail
 
 template<typename T>
-inline auto query_aggregate(sqlite3& db, const char* sql, auto&&... placeholder_values) -> std::expected<std::vector<T>, error> {
+inline auto query_aggregate(connection& db, const char* sql, auto&&... placeholder_values) -> std::expected<std::vector<T>, error> {
     auto ret = std::vector<T>{};
 
     TRY(detail::query_impl(
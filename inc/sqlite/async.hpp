@@ -0,0 +1,154 @@
+#pragma once
+
+#include <sqlite/aggregate.hpp>
+#include <sqlite/database.hpp>
+#include <sqlite/exec.hpp>
+#include <sqlite/query.hpp>
+#include <sqlite/transaction.hpp>
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <ranges>
+#include <vector>
+
+namespace sqlite {
+
+// runs queries on dedicated database threads so that waiting on the disk never
+// blocks the threads that run the io_context
+//
+// - every awaitable returned from here resumes on the executor of the
+//   coroutine that awaited it.
+// - placeholder values are copied to the database thread.
+// - query and query_aggregate are spread across the read only connections of
+//   the pool. if there are none they go to the writer and are serialized with
+//   everything else that does. exec and run always go to the writer.
+struct async_database {
+    explicit async_database(pool connections, usize threads = 1uz)
+        : m_database(std::move(connections.m_writer))
+        , m_readers(std::move(connections.m_readers))
+        , m_pool(std::max(threads, 1uz)) {}
+
+    async_database(async_database const&) = delete;
+    async_database(async_database&&) = delete;
+
+    ~async_database() { m_pool.join(); }
+
+    // the underlying connection, for synchronous use
+    auto get_database() const -> connection& { return *m_database; }
+
+    // runs `fun(connection&)` on a database thread
+    //
+    // calls to run (and everything built on it) are serialized so that a
+    // transaction that is open on the writer can't pick up someone else's
+    // statements.
+    template<typename Fun>
+    auto run(Fun fun) -> boost::asio::awaitable<std::invoke_result_t<Fun&, connection&>> {
+        using R = std::invoke_result_t<Fun&, connection&>;
+
+        co_return co_await boost::asio::co_spawn(
+          m_pool.get_executor(),
+          [this, fun = std::move(fun)] mutable -> boost::asio::awaitable<R> {
+              auto _ = std::unique_lock{m_writer_mutex};
+              co_return std::invoke(fun, *m_database);
+          },
+          boost::asio::use_awaitable
+        );
+    }
+
+    // runs `fun(connection&)` in an immediate transaction on the writer
+    //
+    // `fun` returns an std::expected-like result, the transaction is committed
+    // if it holds a value and rolled back otherwise.
+    template<typename Fun>
+    auto transact(Fun fun) -> boost::asio::awaitable<std::invoke_result_t<Fun&, connection&>> {
+        using R = std::invoke_result_t<Fun&, connection&>;
+
+        return run([fun = std::move(fun)](connection& db) mutable -> R {
+            auto scope = transaction::begin(db);
+            if (!scope) {
+                return std::unexpected{std::move(scope.error())};
+            }
+
+            auto ret = std::invoke(fun, db);
+            if (!ret) {
+                return ret;
+            }
+
+            if (auto res = scope->commit(); !res) {
+                return std::unexpected{std::move(res.error())};
+            }
+
+            return ret;
+        });
+    }
+
+    // runs `fun(connection&)` on a database thread with a read only connection
+    //
+    // without any readers this goes through run, the writer would otherwise be
+    // shared with whatever transaction is open on it.
+    template<typename Fun>
+    auto read(Fun fun) -> boost::asio::awaitable<std::invoke_result_t<Fun&, connection&>> {
+        using R = std::invoke_result_t<Fun&, connection&>;
+
+        if (m_readers.empty()) {
+            co_return co_await run(std::move(fun));
+        }
+
+        co_return co_await boost::asio::co_spawn(
+          m_pool.get_executor(),
+          [&reader = next_reader(), fun = std::move(fun)] mutable -> boost::asio::awaitable<R> {
+              co_return std::invoke(fun, reader);  //
+          },
+          boost::asio::use_awaitable
+        );
+    }
+
+    template<typename... Ts>
+    auto query(const char* sql, auto... placeholder_values) {
+        return read([sql, ... values = std::move(placeholder_values)](connection& db) {
+            return sqlite::query<Ts...>(db, sql, values...);  //
+        });
+    }
+
+    template<typename T>
+    auto query_aggregate(const char* sql, auto... placeholder_values) {
+        return read([sql, ... values = std::move(placeholder_values)](connection& db) {
+            return sqlite::query_aggregate<T>(db, sql, values...);  //
+        });
+    }
+
+    auto exec(const char* sql, auto... placeholder_values) {
+        return run([sql, ... values = std::move(placeholder_values)](connection& db) {
+            return sqlite::exec(db, sql, values...);  //
+        });
+    }
+
+    template<std::ranges::input_range Range>
+    auto exec_many(const char* sql, Range rows) {
+        return run([sql, rows = std::move(rows)](connection& db) {
+            return sqlite::exec_many(db, sql, rows);  //
+        });
+    }
+
+private:
+    database m_database;
+    std::mutex m_writer_mutex{};
+    std::vector<database> m_readers;
+    std::atomic<usize> m_next_reader{0uz};
+
+    boost::asio::thread_pool m_pool;
+
+    // connections serialize their own use so handing the same reader to two
+    // threads is fine, it would just be slower. only called when there are
+    // readers, see read.
+    auto next_reader() -> connection& {
+        return *m_readers[m_next_reader.fetch_add(1uz, std::memory_order_relaxed) % m_readers.size()];
+    }
+};
+
+}  // namespace sqlite
@@ -2,15 +2,157 @@
 
 #include <sqlite/error.hpp>
 
+#include <stuff/core/integers.hpp>
+
 #include <sqlite3.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace sqlite {
 
-using database = std::shared_ptr<sqlite3>;
+struct statement_deleter {
+    void operator()(sqlite3_stmt* statement) const { sqlite3_finalize(statement); }
+};
+
+using statement = std::unique_ptr<sqlite3_stmt, statement_deleter>;
+
+struct statement_cache_stats {
+    usize m_hits;
+    usize m_misses;
+    usize m_cached;
+};
+
+struct connection;
+
+// a prepared statement borrowed from a connection's statement cache
+//
+// the statement gets reset, its bindings get cleared and it gets put back in
+// the cache when the lease goes away, on error paths as well.
+struct statement_lease {
+    statement_lease(connection& connection, std::string_view sql, statement statement)
+        : m_connection(&connection)
+        , m_sql(sql)
+        , m_statement(std::move(statement)) {}
+
+    statement_lease(statement_lease const&) = delete;
+    statement_lease(statement_lease&& other) noexcept = default;
+
+    ~statement_lease();
+
+    auto get() const -> sqlite3_stmt* { return m_statement.get(); }
+
+private:
+    connection* m_connection;
+    std::string_view m_sql;
+    statement m_statement;
+};
+
+struct connection {
+    // takes ownership of the handle
+    explicit connection(sqlite3* handle)
+        : m_handle(handle) {}
+
+    connection(connection const&) = delete;
+    connection(connection&&) = delete;
+
+    ~connection();
+
+    auto handle() const -> sqlite3* { return m_handle; }
+
+    // - hands out a cached statement for the exact same sql text if there is
+    //   an idle one, prepares a new one otherwise.
+    // - `sql` has to outlive the lease.
+    auto acquire(std::string_view sql) -> std::expected<statement_lease, error>;
+
+    auto cache_stats() const -> statement_cache_stats;
+
+    // statements are finalized instead of being cached once this many
+    // distinct sql strings are cached
+    inline static constexpr usize max_cached_statements = 64uz;
+
+private:
+    friend struct statement_lease;
+
+    struct string_hash {
+        using is_transparent = void;
+        auto operator()(std::string_view str) const -> usize { return std::hash<std::string_view>{}(str); }
+    };
+
+    sqlite3* m_handle;
+
+    mutable std::mutex m_cache_mutex{};
+    // more than one statement per query if the same query is running on
+    // multiple threads at once
+    std::unordered_map<std::string, std::vector<statement>, string_hash, std::equal_to<>> m_cache{};
+
+    std::atomic<usize> m_hits{0uz};
+    std::atomic<usize> m_misses{0uz};
+
+    void release(std::string_view sql, statement statement);
+};
+
+using database = std::shared_ptr<connection>;
+
+enum class journal_mode {
+    // whatever the database file already uses
+    unchanged,
+    delete_,
+    truncate,
+    persist,
+    memory,
+    wal,
+    off,
+};
+
+enum class synchronous_mode {
+    unchanged,
+    off,
+    normal,
+    full,
+    extra,
+};
+
+struct open_options {
+    // ignored for read only connections, the journal mode is a property of
+    // the database file and the writer gets to pick it
+    journal_mode m_journal_mode = journal_mode::unchanged;
+    synchronous_mode m_synchronous = synchronous_mode::unchanged;
+
+    // in bytes, see `PRAGMA mmap_size`
+    std::optional<i64> m_mmap_size = std::nullopt;
+    // positive values are in pages, negative ones in KiB, see `PRAGMA cache_size`
+    std::optional<i64> m_cache_size = std::nullopt;
+    // in milliseconds, how long to retry for when the database is locked
+    std::optional<int> m_busy_timeout = std::nullopt;
+
+    bool m_read_only = false;
+};
+
+extern auto open(const char* filename, open_options const& options = {}) -> std::expected<database, error>;
+
+// one connection for everything that writes and some read only ones that
+// lookups can be spread across
+//
+// readers only see what the writer commits if the database is in WAL mode,
+// other journal modes would have them block each other instead.
+struct pool {
+    // so that a plain connection can be used wherever a pool is expected
+    pool(database writer, std::vector<database> readers = {})
+        : m_writer(std::move(writer))
+        , m_readers(std::move(readers)) {}
 
-extern auto open(const char* filename) -> std::expected<database, error>;
+    database m_writer;
+    std::vector<database> m_readers;
+};
 
-}
+// opens the writer with `options` and then `readers` read only connections
+// with the same options
+extern auto open_pool(const char* filename, open_options const& options, usize readers) -> std::expected<pool, error>;
 
+}  // namespace sqlite
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <sqlite/database.hpp>
 #include <sqlite/error.hpp>
 
 #include <sqlite3.h>
@@ -7,6 +8,13 @@
 #include <stuff/core/integers.hpp>
 #include <stuff/core/try.hpp>
 
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace sqlite {
 
 // column_reader
@@ -33,18 +41,60 @@ struct column_reader<i64> {
     inline static constexpr auto reader = sqlite3_column_int64;
 };
 
+template<std::floating_point T>
+struct column_reader<T> {
+    static auto reader(sqlite3_stmt* statement, int column_no) -> T {
+        return static_cast<T>(sqlite3_column_double(statement, column_no));  //
+    }
+};
+
+template<>
+struct column_reader<std::vector<std::byte>> {
+    static auto reader(sqlite3_stmt* statement, int column_no) -> std::vector<std::byte> {
+        const auto* const data = static_cast<const std::byte*>(sqlite3_column_blob(statement, column_no));
+        const auto size = static_cast<usize>(sqlite3_column_bytes(statement, column_no));
+
+        return data == nullptr ? std::vector<std::byte>{} : std::vector<std::byte>(data, data + size);
+    }
+};
+
 template<>
 struct column_reader<std::string> {
     static auto reader(sqlite3_stmt* statement, int column_no) -> std::string {
-        // TODO: add support for column_reader_t<optional<T>>
         const auto* const str = reinterpret_cast<const char*>(sqlite3_column_text(statement, column_no));
         return str == nullptr ? "" : str;
     }
 };
 
+// only valid until the statement is stepped, reset or finalized
+template<>
+struct column_reader<std::string_view> {
+    static auto reader(sqlite3_stmt* statement, int column_no) -> std::string_view {
+        const auto* const str = reinterpret_cast<const char*>(sqlite3_column_text(statement, column_no));
+        if (str == nullptr) {
+            return {};
+        }
+
+        // sqlite3_column_bytes has to come after sqlite3_column_text
+        return {str, static_cast<usize>(sqlite3_column_bytes(statement, column_no))};
+    }
+};
+
 template<typename T>
 using column_reader_t = column_reader<std::remove_cvref_t<T>>;
 
+// std::nullopt for NULL columns
+template<typename T>
+struct column_reader<std::optional<T>> {
+    static auto reader(sqlite3_stmt* statement, int column_no) -> std::optional<T> {
+        if (sqlite3_column_type(statement, column_no) == SQLITE_NULL) {
+            return std::nullopt;
+        }
+
+        return static_cast<T>(std::invoke(column_reader_t<T>::reader, statement, column_no));
+    }
+};
+
 template<typename T>
 concept column_readable = requires { column_reader<std::remove_cvref_t<T>>::reader; };
 
@@ -58,23 +108,107 @@ struct binder;
 
 template<std::signed_integral T>
 struct binder<T> {
-    inline static constexpr auto bind_fn = sqlite3_bind_int;
+    static auto bind_fn(sqlite3_stmt* statement, int column, T value) -> int {
+        if constexpr (sizeof(T) <= sizeof(int)) {
+            return sqlite3_bind_int(statement, column, value);
+        } else {
+            return sqlite3_bind_int64(statement, column, value);
+        }
+    }
+};
+
+// anything that doesn't fit in an i64 would silently wrap around
+template<std::unsigned_integral T>
+    requires(sizeof(T) < sizeof(i64))
+struct binder<T> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, T value) -> int {
+        return sqlite3_bind_int64(statement, column, static_cast<i64>(value));  //
+    }
 };
 
 template<>
-struct binder<i64> {
-    inline static constexpr auto bind_fn = sqlite3_bind_int;
+struct binder<bool> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, bool value) -> int {
+        return sqlite3_bind_int(statement, column, value ? 1 : 0);  //
+    }
+};
+
+template<std::floating_point T>
+struct binder<T> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, T value) -> int {
+        return sqlite3_bind_double(statement, column, static_cast<double>(value));  //
+    }
 };
 
 template<>
 struct binder<std::string> {
-    static auto bind_fn(sqlite3_stmt* statement, int column, std::string const& str) {
-        sqlite3_bind_text(statement, column, str.c_str(), str.size(), SQLITE_TRANSIENT);  //
+    static auto bind_fn(sqlite3_stmt* statement, int column, std::string const& str) -> int {
+        return sqlite3_bind_text(statement, column, str.c_str(), str.size(), SQLITE_TRANSIENT);  //
+    }
+};
+
+template<>
+struct binder<std::string_view> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, std::string_view str) -> int {
+        return sqlite3_bind_text(statement, column, str.data(), str.size(), SQLITE_TRANSIENT);  //
+    }
+};
+
+template<>
+struct binder<std::span<const std::byte>> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, std::span<const std::byte> blob) -> int {
+        return sqlite3_bind_blob64(statement, column, blob.data(), blob.size(), SQLITE_TRANSIENT);  //
+    }
+};
+
+template<>
+struct binder<std::vector<std::byte>> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, std::vector<std::byte> const& blob) -> int {
+        return binder<std::span<const std::byte>>::bind_fn(statement, column, blob);  //
+    }
+};
+
+template<>
+struct binder<std::nullptr_t> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, std::nullptr_t) -> int {
+        return sqlite3_bind_null(statement, column);  //
+    }
+};
+
+template<>
+struct binder<std::nullopt_t> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, std::nullopt_t) -> int {
+        return sqlite3_bind_null(statement, column);  //
     }
 };
 
 template<typename T>
-using binder_t = typename binder<std::remove_cvref_t<T>>::binder;
+struct binder<std::optional<T>> {
+    static auto bind_fn(sqlite3_stmt* statement, int column, std::optional<T> const& value) -> int {
+        if (!value) {
+            return sqlite3_bind_null(statement, column);
+        } else {
+            return binder<std::remove_cvref_t<T>>::bind_fn(statement, column, *value);
+        }
+    }
+};
+
+template<typename T>
+using binder_t = binder<std::remove_cvref_t<T>>;
+
+// stops at the first value that fails to bind (e.g. because there are more
+// values than placeholders)
+[[nodiscard]] inline auto bind_all(sqlite3_stmt* statement, auto const&... placeholder_values) -> std::expected<void, error> {
+    auto bind_column = 1;
+    auto res = SQLITE_OK;
+    static_cast<void>((((res = binder_t<decltype(placeholder_values)>::bind_fn(statement, bind_column++, placeholder_values)) == SQLITE_OK) && ...));
+
+    if (res != SQLITE_OK) {
+        return std::unexpected{error(res, sqlite3_errmsg(sqlite3_db_handle(statement)))};
+    }
+
+    return {};
+}
 
 }  // namespace detail
 
@@ -89,15 +223,18 @@ struct reader;
 // query_impl
 namespace detail {
 
-template<typename Fun>
-[[nodiscard]] inline auto query_impl(sqlite3& db, const char* sql, Fun&& callback, auto&&... placeholder_values) -> std::expected<void, error> {
-    auto* statement = (sqlite3_stmt*)nullptr;
-    if (auto res = sqlite3_prepare_v2(&db, sql, -1, &statement, nullptr); res != SQLITE_OK) {
-        return std::unexpected{error(res, sqlite3_errmsg(&db))};
-    }
+// a cached statement for `sql` with `placeholder_values` bound to it
+[[nodiscard]] inline auto prepare(connection& db, const char* sql, auto&&... placeholder_values) -> std::expected<statement_lease, error> {
+    auto lease = TRY(db.acquire(sql));
+    TRY(bind_all(lease.get(), placeholder_values...));
 
-    auto bind_column = 1;
-    (detail::binder<std::remove_cvref_t<decltype(placeholder_values)>>::bind_fn(statement, bind_column++, placeholder_values), ...);
+    return lease;
+}
+
+template<typename Fun>
+[[nodiscard]] inline auto query_impl(connection& db, const char* sql, Fun&& callback, auto&&... placeholder_values) -> std::expected<void, error> {
+    auto lease = TRY(prepare(db, sql, std::forward<decltype(placeholder_values)>(placeholder_values)...));
+    auto* const statement = lease.get();
 
     auto res = SQLITE_OK;
     while ((res = sqlite3_step(statement)) == SQLITE_ROW) {
@@ -105,11 +242,9 @@ template<typename Fun>
     }
 
     if (res != SQLITE_DONE) {
-        return std::unexpected{error(res, sqlite3_errmsg(&db))};
+        return std::unexpected{error(res, sqlite3_errmsg(db.handle()))};
     }
 
-    sqlite3_finalize(statement);
-
     return {};
 }
 
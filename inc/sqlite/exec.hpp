@@ -2,14 +2,19 @@
 
 #include <sqlite/detail/query.hpp>
 #include <sqlite/error.hpp>
+#include <sqlite/transaction.hpp>
 
 #include <sqlite3.h>
 
 #include <stuff/core/integers.hpp>
 
+#include <optional>
+#include <ranges>
+#include <tuple>
+
 namespace sqlite {
 
-inline auto exec(sqlite3& db, const char* sql, auto&&... placeholder_values) -> std::expected<void, error> {
+inline auto exec(connection& db, const char* sql, auto&&... placeholder_values) -> std::expected<void, error> {
     sqlite3_exec;
 
     TRY(detail::query_impl(
@@ -23,4 +28,51 @@ inline auto exec(sqlite3& db, const char* sql, auto&&... placeholder_values) ->
     return {};
 }
 
+// runs every statement in `sql` one after the other, stopping at the first one
+// that fails. there are no placeholders, this is for things like schema.sql.
+extern auto exec_script(connection& db, const char* sql) -> std::expected<void, error>;
+
+// runs `sql` once for every tuple in `rows` with the tuple's elements as the
+// placeholder values, reusing one prepared statement for all of them
+//
+// everything happens in one transaction unless one is already active on the
+// connection, in which case the caller is in charge of committing. returns the
+// amount of rows the statement was run for, or the first error, whether from
+// binding a row or from running the statement.
+template<std::ranges::input_range Range>
+inline auto exec_many(connection& db, const char* sql, Range&& rows) -> std::expected<usize, error> {
+    auto scope = std::optional<transaction>{};
+    if (sqlite3_get_autocommit(db.handle()) != 0) {
+        scope.emplace(TRY(transaction::begin(db)));
+    }
+
+    auto lease = TRY(db.acquire(sql));
+    auto* const statement = lease.get();
+
+    auto ran_for = 0uz;
+    for (auto const& row : rows) {
+        // a row that can't be bound aborts the batch like a failing step
+        // does, which rolls back the transaction if it is ours
+        if (auto bound = std::apply([statement](auto const&... values) { return detail::bind_all(statement, values...); }, row); !bound) {
+            return std::unexpected{std::move(bound.error())};
+        }
+
+        const auto res = sqlite3_step(statement);
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+
+        if (res != SQLITE_DONE && res != SQLITE_ROW) {
+            return std::unexpected{error(res, sqlite3_errmsg(db.handle()))};
+        }
+
+        ran_for++;
+    }
+
+    if (scope) {
+        TRY(scope->commit());
+    }
+
+    return ran_for;
+}
+
 }  // namespace sqlite
@@ -51,7 +51,7 @@ struct reader<T> {
 }  // namespace detail
 
 template<typename... Ts>
-inline auto query(sqlite3& db, const char* sql, auto&&... placeholder_values) -> std::expected<std::vector<detail::exec_return_t<Ts...>>, error> {
+inline auto query(connection& db, const char* sql, auto&&... placeholder_values) -> std::expected<std::vector<detail::exec_return_t<Ts...>>, error> {
     using U = detail::exec_return_t<Ts...>;
     auto ret = std::vector<U>{};
 
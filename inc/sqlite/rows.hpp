@@ -0,0 +1,104 @@
+#pragma once
+
+#include <sqlite/aggregate.hpp>
+#include <sqlite/database.hpp>
+#include <sqlite/detail/query.hpp>
+#include <sqlite/error.hpp>
+#include <sqlite/query.hpp>
+
+#include <sqlite3.h>
+
+#include <stuff/core/integers.hpp>
+#include <stuff/core/try.hpp>
+
+#include <iterator>
+#include <optional>
+
+namespace sqlite {
+
+// rows of a query, stepped through one at a time as they are iterated over
+//
+// - single pass, the range can't be iterated over twice.
+// - std::string_view columns point into sqlite's own buffers and are only
+//   valid until the iterator is incremented.
+// - the statement goes back to the connection's cache as soon as the last row
+//   has been read (or an error was encountered), or when the range goes away.
+// - check `status()` after iterating, a failing sqlite3_step ends the range
+//   the same way running out of rows does.
+template<typename T>
+struct row_range {
+    row_range(connection& db, statement_lease lease)
+        : m_database(&db)
+        , m_lease(std::move(lease)) {
+        advance();
+    }
+
+    row_range(row_range const&) = delete;
+    row_range(row_range&&) noexcept = default;
+
+    struct sentinel {};
+
+    struct iterator {
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        auto operator*() const -> T const& { return *m_range->m_current; }
+        auto operator->() const -> T const* { return &*m_range->m_current; }
+
+        auto operator++() -> iterator& {
+            m_range->advance();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend auto operator==(iterator const& it, sentinel) -> bool { return !it.m_range->m_current; }
+
+        row_range* m_range;
+    };
+
+    auto begin() -> iterator { return {this}; }
+    auto end() -> sentinel { return {}; }
+
+    auto status() const -> std::expected<void, error> const& { return m_status; }
+
+private:
+    connection* m_database;
+    std::optional<statement_lease> m_lease;
+
+    std::optional<T> m_current = std::nullopt;
+    std::expected<void, error> m_status{};
+
+    void advance() {
+        m_current.reset();
+        if (!m_lease) {
+            return;
+        }
+
+        auto* const statement = m_lease->get();
+
+        if (auto res = sqlite3_step(statement); res == SQLITE_ROW) {
+            if (auto row = detail::reader<T>::read(statement); row) {
+                m_current.emplace(std::move(*row));
+                return;
+            } else {
+                m_status = std::unexpected{std::move(row.error())};
+            }
+        } else if (res != SQLITE_DONE) {
+            m_status = std::unexpected{error(res, sqlite3_errmsg(m_database->handle()))};
+        }
+
+        m_lease.reset();
+    }
+};
+
+// like `query` but without collecting the rows into a vector first
+//
+// `Ts...` can be a single aggregate as well as a list of column types.
+template<typename... Ts>
+inline auto stream(connection& db, const char* sql, auto&&... placeholder_values) -> std::expected<row_range<detail::exec_return_t<Ts...>>, error> {
+    auto lease = TRY(detail::prepare(db, sql, std::forward<decltype(placeholder_values)>(placeholder_values)...));
+    return row_range<detail::exec_return_t<Ts...>>(db, std::move(lease));
+}
+
+}  // namespace sqlite
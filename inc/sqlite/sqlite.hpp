@@ -1,7 +1,10 @@
 #pragma once
 
 #include <sqlite/aggregate.hpp>
+#include <sqlite/async.hpp>
 #include <sqlite/database.hpp>
 #include <sqlite/error.hpp>
 #include <sqlite/exec.hpp>
 #include <sqlite/query.hpp>
+#include <sqlite/rows.hpp>
+#include <sqlite/transaction.hpp>
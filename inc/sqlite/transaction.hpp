@@ -0,0 +1,46 @@
+#pragma once
+
+#include <sqlite/database.hpp>
+#include <sqlite/error.hpp>
+
+#include <expected>
+#include <utility>
+
+namespace sqlite {
+
+enum class transaction_kind {
+    deferred,
+    // takes the write lock right away, what should be used for anything that
+    // is going to write
+    immediate,
+    exclusive,
+};
+
+// rolls back on destruction unless it has been committed
+//
+// transactions don't nest, beginning one while another one is active on the
+// same connection fails.
+struct transaction {
+    static auto begin(connection& db, transaction_kind kind = transaction_kind::immediate) -> std::expected<transaction, error>;
+
+    transaction(transaction const&) = delete;
+    transaction(transaction&& other) noexcept
+        : m_database(std::exchange(other.m_database, nullptr)) {}
+
+    ~transaction();
+
+    auto commit() -> std::expected<void, error>;
+    auto rollback() -> std::expected<void, error>;
+
+    auto active() const -> bool { return m_database != nullptr; }
+
+private:
+    explicit transaction(connection& db)
+        : m_database(&db) {}
+
+    connection* m_database;
+
+    auto finish(const char* sql) -> std::expected<void, error>;
+};
+
+}  // namespace sqlite
@@ -18,6 +18,13 @@ struct client final : thing {
 
     auto get_id() const -> std::string_view override { return m_config.m_identifier; }
 
+    auto interests() const -> payload_mask override { return payload_mask_of<payloads::outgoing_message, payloads::multicast_message>(); }
+
+    auto connector_ident() const -> std::optional<std::string_view> override { return m_config.m_identifier; }
+
+    // the length limit of sendMessage
+    auto coalescing() const -> std::optional<coalescing_limits> override { return coalescing_limits{.m_max_size = 4096uz, .m_separator = "\n"}; }
+
     auto worker(bot& bot) -> boost::asio::awaitable<anyhow::result<void>> override;
 
     auto handle(message const& msg) -> boost::asio::awaitable<anyhow::result<void>> override;
@@ -33,8 +40,13 @@ private:
 
     auto worker_inner() -> boost::asio::awaitable<anyhow::result<void>>;
 
+    // translates an update into a message for the bus, std::nullopt if there
+    // is nothing to queue
     template<typename T>
-    auto handle_update(T const& update) -> boost::asio::awaitable<anyhow::result<void>>;
+    auto handle_update(T const& update) -> anyhow::result<std::optional<message>>;
+
+    // does nothing if the target belongs to some other connector
+    auto send_to(mini_kv const& target, std::string_view content) -> boost::asio::awaitable<void>;
 
     template<typename Payload>
     auto bot_message_handler(john::message const& msg, Payload const& payload) -> boost::asio::awaitable<anyhow::result<void>>;
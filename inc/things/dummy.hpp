@@ -9,6 +9,8 @@ struct dummy final : thing {
 
     auto get_id() const -> std::string_view override { return "dummy"; }
 
+    auto interests() const -> payload_mask override { return 0; }
+
     auto worker(john::bot& bot) -> boost::asio::awaitable<anyhow::result<void>> override { co_return anyhow::result<void>{}; }
 
     auto handle(john::message const& msg) -> boost::asio::awaitable<anyhow::result<void>> override { co_return anyhow::result<void>{}; }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <bot.hpp>
+
+namespace john::things {
+
+// op commands for changing who may do what, everything goes through
+// bot::get_permissions so the cache and the database stay in sync
+//
+// - setlevel <user kv> <regular|admin|op>
+// - grant <user kv> <command>
+// - revoke <user kv> <command>
+// - reloadperms, after the tables were edited by hand
+struct permissions final : thing {
+    ~permissions() override = default;
+
+    auto get_id() const -> std::string_view override { return "permissions"; }
+
+    auto interests() const -> payload_mask override { return payload_mask_of<payloads::command>(); }
+
+    auto worker(john::bot& bot) -> boost::asio::awaitable<anyhow::result<void>> override;
+
+    auto handle(john::message const& msg) -> boost::asio::awaitable<anyhow::result<void>> override;
+
+private:
+    john::bot* m_bot = nullptr;
+
+    // what to tell the sender
+    auto run_command(payloads::command const& cmd) -> boost::asio::awaitable<anyhow::result<std::string>>;
+};
+
+}  // namespace john::things
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <bloom_filter.hpp>
 #include <bot.hpp>
+#include <kv.hpp>
+#include <kv_pattern_map.hpp>
+
+#include <vector>
 
 namespace john::things {
 
@@ -9,12 +14,35 @@ struct relay final : thing {
 
     auto get_id() const -> std::string_view override { return "relay"; }
 
+    auto interests() const -> payload_mask override { return payload_mask_of<payloads::incoming_message, payloads::command>(); }
+
     auto worker(john::bot& bot) -> boost::asio::awaitable<anyhow::result<void>> override;
 
     auto handle(john::message const& msg) -> boost::asio::awaitable<anyhow::result<void>> override;
 
 private:
     john::bot* m_bot = nullptr;
+
+    // from_kv (which may be a wildcard pattern) -> to_kvs, a copy of
+    // relay_mappings
+    //
+    // only ever touched from the relay's strand. filled in by the worker and
+    // kept up to date by addmap, the database is only read once.
+    kv_pattern_map<mini_kv> m_mappings{};
+
+    // reused across messages
+    std::vector<mini_kv const*> m_targets{};
+
+    // (content, target) fingerprints of what has been relayed recently, an
+    // incoming message matching one of these is an echo
+    rotating_bloom_filter m_recently_relayed{};
+
+    static auto fingerprint(std::string_view content, mini_kv const& target) -> u64;
+
+    auto load_mappings() -> boost::asio::awaitable<anyhow::result<void>>;
+
+    // returns false if the mapping already existed
+    auto add_mapping(std::string_view from, mini_kv to) -> bool;
 };
 
 }  // namespace john::things
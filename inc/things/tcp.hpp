@@ -15,6 +15,16 @@ struct tcp_thing final : thing {
 
     auto get_id() const -> std::string_view override { return "tcp_thing"; }
 
+    auto interests() const -> payload_mask override { return payload_mask_of<payloads::outgoing_message, payloads::multicast_message>(); }
+
+    // the clients are lossy anyway, no point in holding the bus up for them
+    auto mailbox_config() const -> std::optional<mailbox_configuration> override {
+        return mailbox_configuration{
+          .m_capacity = 64uz,
+          .m_policy = overflow_policy::drop_newest,
+        };
+    }
+
     auto worker(john::bot& bot) -> boost::asio::awaitable<anyhow::result<void>> override;
 
     auto handle(john::message const& msg) -> boost::asio::awaitable<anyhow::result<void>> override;
@@ -2,12 +2,14 @@
 #include <assio/as_expected.hpp>
 #include <bot.hpp>
 #include <error.hpp>
+#include <generated/schema.h>
 #include <irc/client.hpp>
 #include <sqlite/aggregate.hpp>
 #include <sqlite/sqlite.hpp>
 #include <telegram/client.hpp>
 #include <things/dummy.hpp>
 #include <things/logger.hpp>
+#include <things/permissions.hpp>
 #include <things/relay.hpp>
 #include <things/tcp.hpp>
 
@@ -19,6 +21,11 @@
 #include <boost/asio.hpp>
 #include <magic_enum.hpp>
 
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
 namespace asio = boost::asio;
 using anyhow::result;
 using asio::awaitable;
@@ -52,9 +59,9 @@ struct irc_entry {
     bool m_enabled;
 };
 
-auto setup_single_irc(john::bot& bot, sqlite3& db, irc_entry entry) -> awaitable<result<void>> {
-    auto nicks = TRYC(sqlite::query<std::string>(db, "select nick from irc_nick_choices where irc_id = ?", entry.m_id));
-    auto channels = TRYC(sqlite::query<std::string>(db, "select channel from irc_channels where irc_id = ?", entry.m_id));
+auto setup_single_irc(john::bot& bot, sqlite::async_database& db, irc_entry entry) -> awaitable<result<void>> {
+    auto nicks = TRYC(co_await db.query<std::string>("select nick from irc_nick_choices where irc_id = ?", entry.m_id));
+    auto channels = TRYC(co_await db.query<std::string>("select channel from irc_channels where irc_id = ?", entry.m_id));
 
     if (nicks.empty()) {
         co_return _anyhow("no nicks given");
@@ -80,8 +87,8 @@ auto setup_single_irc(john::bot& bot, sqlite3& db, irc_entry entry) -> awaitable
     co_return result<void>{};
 }
 
-auto setup_irc(john::bot& bot, sqlite3& db) -> awaitable<result<void>> {
-    for (auto&& entry : TRYC(sqlite::query<irc_entry>(db, "select rowid, * from clients_irc"))) {
+auto setup_irc(john::bot& bot, sqlite::async_database& db) -> awaitable<result<void>> {
+    for (auto&& entry : TRYC(co_await db.query<irc_entry>("select rowid, * from clients_irc"))) {
         auto id = entry.m_id;
 
         if (!entry.m_enabled) {
@@ -99,8 +106,8 @@ auto setup_irc(john::bot& bot, sqlite3& db) -> awaitable<result<void>> {
     co_return result<void>{};
 }
 
-auto setup_telegram(john::bot& bot, sqlite3& db) -> awaitable<result<void>> {
-    for (auto const& [id, token, enabled] : TRYC(sqlite::query<i64, std::string, bool>(db, "select * from clients_telegram"))) {
+auto setup_telegram(john::bot& bot, sqlite::async_database& db) -> awaitable<result<void>> {
+    for (auto const& [id, token, enabled] : TRYC(co_await db.query<i64, std::string, bool>("select * from clients_telegram"))) {
         if (!enabled) {
             spdlog::info("skipping the telegram client with id {} as it is disabled", id);
             continue;
@@ -119,7 +126,7 @@ auto setup_telegram(john::bot& bot, sqlite3& db) -> awaitable<result<void>> {
     co_return result<void>{};
 }
 
-auto setup_bot(john::bot& bot, sqlite3& db) -> awaitable<void> {
+auto setup_bot(john::bot& bot, sqlite::async_database& db) -> awaitable<void> {
     if (auto res = co_await setup_irc(bot, db); !res) {
         spdlog::warn("failed to set up any irc clients");
     }
@@ -131,27 +138,41 @@ auto setup_bot(john::bot& bot, sqlite3& db) -> awaitable<void> {
     co_await add_thing<john::things::dummy>(bot);
     co_await add_thing<john::things::relay>(bot);
     co_await add_thing<john::things::logger>(bot);
+    co_await add_thing<john::things::permissions>(bot);
     co_await add_thing<john::things::tcp_thing>(bot, co_await asio::this_coro::executor);
 
     co_return;
 }
 
-auto launch_bot() -> awaitable<result<void>> {
+auto launch_bot(john::bot_configuration config) -> awaitable<result<void>> {
     namespace asio = boost::asio;
     using boost::asio::ip::tcp;
 
-    auto db = TRYC(sqlite::open("db.sqlite"));
+    const auto db_options = sqlite::open_options{
+      .m_journal_mode = sqlite::journal_mode::wal,
+      .m_synchronous = sqlite::synchronous_mode::normal,
+      .m_mmap_size = 64 * 1024 * 1024,
+      .m_cache_size = -8 * 1024,
+      .m_busy_timeout = 5000,
+    };
+
+    auto db = TRYC(sqlite::open_pool("db.sqlite", db_options, config.m_database_threads));
+
+    // every table is "create if not exists", this only adds what is missing
+    // from older databases. nothing else is running yet so the writer is used
+    // directly.
+    TRYC(sqlite::exec_script(*db.m_writer, reinterpret_cast<const char*>(schema_str)));
 
     auto executor = co_await asio::this_coro::executor;
 
-    auto bot = john::bot(db, executor);
+    auto bot = john::bot(std::move(db), executor, config);
 
     boost::asio::co_spawn(
       executor,
       [&]() -> awaitable<void> {
           co_await boost::asio::deadline_timer(co_await boost::asio::this_coro::executor, boost::posix_time::seconds(1)).async_wait(boost::asio::use_awaitable);
 
-          co_await setup_bot(bot, *db);
+          co_await setup_bot(bot, bot.get_async_db());
 
           co_return;
       },
@@ -167,24 +188,63 @@ auto launch_bot() -> awaitable<result<void>> {
     co_return result<void>{};
 }
 
-auto async_main() -> awaitable<void> {
+auto async_main(john::bot_configuration config) -> awaitable<void> {
     auto executor = co_await boost::asio::this_coro::executor;
 
-    if (auto res = co_await launch_bot(); !res) {
+    if (auto res = co_await launch_bot(config); !res) {
         spdlog::error("{}", static_cast<john::error const&>(res.error()));
     }
 
     co_return;
 }
 
+static auto env_or(const char* name, usize default_value) -> usize {
+    const auto* const str = std::getenv(name);
+    if (str == nullptr) {
+        return default_value;
+    }
+
+    auto ret = default_value;
+    if (auto res = std::from_chars(str, str + std::strlen(str), ret); res.ec != std::errc{}) {
+        spdlog::warn("the environment variable {} (\"{}\") is not a number, defaulting to {}", name, str, default_value);
+        return default_value;
+    }
+
+    return ret;
+}
+
+static auto configuration_from_env() -> john::bot_configuration {
+    auto ret = john::bot_configuration{};
+
+    ret.m_worker_threads = std::max(env_or("JOHN_THREADS", std::max(std::thread::hardware_concurrency(), 1u)), 1uz);
+
+    ret.m_database_threads = std::max(env_or("JOHN_DB_THREADS", ret.m_database_threads), 1uz);
+    ret.m_coalesce_window = std::chrono::milliseconds(env_or("JOHN_COALESCE_MS", static_cast<usize>(ret.m_coalesce_window.count())));
+
+    ret.m_bus_capacity = std::max(env_or("JOHN_BUS_CAPACITY", ret.m_bus_capacity), 1uz);
+    ret.m_bus_high_watermark = std::min(env_or("JOHN_BUS_HIGH_WATERMARK", ret.m_bus_capacity * 3 / 4), ret.m_bus_capacity);
+    ret.m_bus_low_watermark = std::min(env_or("JOHN_BUS_LOW_WATERMARK", ret.m_bus_capacity / 4), ret.m_bus_high_watermark);
+
+    return ret;
+}
+
 auto main() -> int {
     spdlog::set_level(spdlog::level::trace);
     spdlog::info("Hello, world!");
 
-    auto context = boost::asio::io_context{1};
+    const auto config = configuration_from_env();
+    spdlog::info("running with {} worker thread(s)", config.m_worker_threads);
+
+    auto context = boost::asio::io_context{static_cast<int>(config.m_worker_threads)};
     // auto guard = boost::asio::make_work_guard(context);
 
-    boost::asio::co_spawn(context, async_main(), boost::asio::detached);
+    boost::asio::co_spawn(context, async_main(config), boost::asio::detached);
+
+    auto threads = std::vector<std::jthread>{};
+    threads.reserve(config.m_worker_threads - 1);
+    for (auto i = 1uz; i < config.m_worker_threads; i++) {
+        threads.emplace_back([&context] { context.run(); });
+    }
 
     context.run();
 }
@@ -58,3 +58,10 @@ create table if not exists user_levels (
 
   primary key (user_kv)
 );
+
+create table if not exists command_grants (
+  user_kv text not null,
+  command text not null,
+
+  primary key (user_kv, command)
+);
@@ -8,10 +8,13 @@
 #include <boost/asio/bind_cancellation_slot.hpp>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
-#include <boost/asio/experimental/parallel_group.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/asio/use_awaitable.hpp>
 #include <boost/asio/use_future.hpp>
 
+#include <algorithm>
+
 namespace asio = boost::asio;
 using anyhow::result;
 using asio::awaitable;
@@ -21,39 +24,141 @@ using asio::awaitable;
 
 namespace john {
 
+auto default_priority(message const& msg) -> message_priority {
+    if (msg.m_reply_serial) {
+        return message_priority::control;
+    }
+
+    const auto visitor = stf::multi_visitor{
+      [](payloads::incoming_message const&) { return message_priority::bulk; },
+      [](payloads::outgoing_message const&) { return message_priority::bulk; },
+      [](payloads::multicast_message const&) { return message_priority::bulk; },
+      [](payloads::other const&) { return message_priority::bulk; },
+      [](auto const&) { return message_priority::control; },
+    };
+
+    return std::visit(visitor, msg.m_payload);
+}
+
+auto bot::try_receive_next() -> std::optional<message> {
+    auto ret = std::optional<message>{};
+
+    const auto try_lane = [&ret](lane_type& lane) {
+        return lane.try_receive([&ret](boost::system::error_code ec, message msg) {
+            if (!ec) {
+                ret.emplace(std::move(msg));
+            }
+        });
+    };
+
+    // control traffic goes first, up to a point
+    if (m_control_streak < m_config.m_control_burst) {
+        if (try_lane(m_control_channel) && ret) {
+            m_control_streak++;
+            return ret;
+        }
+
+        m_control_streak = 0uz;
+        try_lane(m_message_channel);
+        return ret;
+    }
+
+    m_control_streak = 0uz;
+    if (try_lane(m_message_channel) && ret) {
+        return ret;
+    }
+
+    try_lane(m_control_channel);
+    return ret;
+}
+
 auto bot::run() -> awaitable<result<void>> {
-    for (;;) {
-        spdlog::trace("awaiting message retreival");
-        auto res = co_await m_message_channel.async_receive();
+    if (auto res = co_await m_async_database.read([this](sqlite::connection& db) { return m_permissions.reload(db); }); !res) {
+        spdlog::error("failed to load the permissions, everyone is a regular user: {}", static_cast<error const&>(res.error()));
+    }
 
-        if (!res && !m_message_channel.is_open()) {
-            spdlog::info("message channel is closed, exiting");
-            break;
+    const auto coalescing = m_config.m_coalesce_window != std::chrono::milliseconds::zero();
+
+    while (!m_exiting) {
+        // batches are sent out from here and nowhere else so that they can't
+        // be overtaken by whatever handle_message delivers next
+        if (coalescing) {
+            co_await flush_batches_due();
         }
 
+        auto res = try_receive_next();
+
         if (!res) {
-            spdlog::error("failed to receive from the message channel, error: {}", res.error().what());
-            spdlog::error("pray that all workers have quit or we're about to hang");
-            break;
+            spdlog::trace("awaiting message retreival");
+
+            // the doorbell is rung by the timer as well, once the earliest
+            // batch is due
+            if (!m_pending_batches.empty() && m_flush_timer.expiry() != m_next_flush) {
+                m_flush_timer.expires_at(m_next_flush);
+                m_flush_timer.async_wait([this](boost::system::error_code ec) {
+                    if (!ec) {
+                        m_doorbell.try_send(boost::system::error_code{});
+                    }
+                });
+            }
+
+            if (auto rang = co_await m_doorbell.async_receive(); !rang) {
+                spdlog::error("failed to wait on the message lanes, error: {}", rang.error().what());
+                spdlog::error("pray that all workers have quit or we're about to hang");
+                break;
+            }
+
+            continue;
+        }
+
+        if (const auto depth = m_bus_depth.fetch_sub(1uz, std::memory_order_acq_rel) - 1uz; depth <= m_config.m_bus_low_watermark && !m_bus_gate.is_open()) {
+            spdlog::debug("the bus has drained down to {} messages, letting producers resume", depth);
+            m_bus_gate.open();
         }
 
         spdlog::trace("new message");
         co_await handle_message(std::move(*res));
     }
 
-    spdlog::debug("going to join the workers");
+    // whatever is left goes out before the mailboxes are closed
+    if (coalescing) {
+        co_await flush_batches_due(true);
+        m_flush_timer.cancel();
+
+        spdlog::debug("{} outgoing message(s) were merged into others", m_coalesced.load(std::memory_order_relaxed));
+    }
+
+    auto mailboxes = std::vector<mailbox*>{};
+    {
+        auto _ = std::shared_lock{m_things_mutex};
+        for (auto const& [id, entry] : m_things) {
+            mailboxes.push_back(entry.m_mailbox.get());
+        }
+    }
 
-    for (auto i = 0uz; i < m_things.size(); i++) {
+    spdlog::debug("going to close the mailboxes and join the workers and the consumers");
+
+    for (auto* box : mailboxes) {
+        co_await box->close();
+    }
+
+    // one worker and one consumer per `thing`
+    const auto coroutine_count = mailboxes.size() * 2uz;
+
+    for (auto i = 0uz; i < coroutine_count; i++) {
         auto res = co_await m_completion_channel.async_receive();
 
         if (!res) {
-            spdlog::error("failed to read from the completion channel with {} remaining workers: {}", m_things.size() - i, res.error().what());
+            spdlog::error("failed to read from the completion channel with {} remaining coroutines: {}", coroutine_count - i, res.error().what());
             break;
         }
 
-        spdlog::debug("the `thing` with the id \"{}\" exited successfuly", *res);
+        spdlog::debug("a coroutine of the `thing` with the id \"{}\" exited successfuly", *res);
     }
 
+    const auto cache_stats = m_database->cache_stats();
+    spdlog::debug("statement cache: {} hit(s), {} miss(es), {} statement(s) cached", cache_stats.m_hits, cache_stats.m_misses, cache_stats.m_cached);
+
     spdlog::info("successfully exited");
 
     co_return result<void>{};
@@ -75,28 +180,127 @@ void bot::set_display_name(john::mini_kv const& kv, std::string name) {
     m_display_names.insert_or_assign(kv, name);
 }
 
-auto bot::queue_message(message message) -> awaitable<usize> {
-    const auto message_serial = m_previous_serial++;
-    message.m_serial = message_serial;
+auto bot::get_mailbox_stats(std::string_view thing_id) const -> std::optional<mailbox_stats> {
+    auto _ = std::shared_lock{m_things_mutex};
 
-    spdlog::debug("a message from \"{}\" addressed to \"{}\" is being queued and got assigned the serial {}", message.m_from, message.m_to, message_serial);
+    if (auto it = m_things.find(std::string{thing_id}); it == m_things.end()) {
+        return std::nullopt;
+    } else {
+        return it->second.m_mailbox->stats();
+    }
+}
 
-    const auto sent_immediately = m_message_channel.try_send(boost::system::error_code{}, std::move(message));
+auto bot::queue_message(message message, std::optional<message_priority> priority) -> awaitable<usize> {
+    co_return co_await queue_messages(std::span{&message, 1uz}, priority);  //
+}
 
-    if (sent_immediately) {
-        spdlog::trace("queued message with serial {} immediately", message_serial);
-        co_return message_serial;
+auto bot::queue_messages(std::span<message> messages, std::optional<message_priority> priority) -> awaitable<usize> {
+    if (messages.empty()) {
+        co_return 0uz;
     }
 
-    auto res = co_await m_message_channel.async_send(boost::system::error_code{}, std::move(message));
+    const auto first_serial = m_previous_serial.fetch_add(messages.size());
 
-    if (!res) {
-        spdlog::error("failed to queue a message: {}", res.error().what());
-    } else {
-        spdlog::trace("queued message with serial {} asynchronously", message_serial);
+    for (auto serial = first_serial; auto& message : messages) {
+        message.m_serial = serial++;
     }
 
-    co_return message_serial;
+    co_await enqueue(messages, priority);
+
+    co_return first_serial;
+}
+
+auto bot::enqueue(std::span<message> messages, std::optional<message_priority> priority) -> awaitable<void> {
+    if (const auto depth = m_bus_depth.fetch_add(messages.size(), std::memory_order_acq_rel) + messages.size(); depth >= m_config.m_bus_high_watermark && m_bus_gate.is_open()) {
+        spdlog::debug("the bus is congested with {} messages, asking producers to hold off", depth);
+        m_bus_gate.close();
+    }
+
+    // whether bot::run might not know about some of the messages yet
+    auto unannounced = false;
+
+    for (auto& message : messages) {
+        const auto serial = message.m_serial;
+
+        spdlog::debug("a message from \"{}\" addressed to \"{}\" is being queued and got assigned the serial {}", message.m_from, message.m_to, message.m_serial);
+
+        auto& lane = priority.value_or(default_priority(message)) == message_priority::control ? m_control_channel : m_message_channel;
+
+        if (lane.try_send(boost::system::error_code{}, std::move(message))) {
+            spdlog::trace("queued message with serial {} immediately", serial);
+            unannounced = true;
+            continue;
+        }
+
+        // bot::run has to be awake to make room
+        if (std::exchange(unannounced, false)) {
+            m_doorbell.try_send(boost::system::error_code{});
+        }
+
+        if (auto res = co_await lane.async_send(boost::system::error_code{}, std::move(message)); !res) {
+            m_bus_depth.fetch_sub(1uz, std::memory_order_acq_rel);
+            spdlog::error("failed to queue a message: {}", res.error().what());
+        } else {
+            spdlog::trace("queued message with serial {} asynchronously", serial);
+            unannounced = true;
+        }
+    }
+
+    if (unannounced) {
+        m_doorbell.try_send(boost::system::error_code{});
+    }
+}
+
+auto bot::wait_for_bus() -> awaitable<void> {
+    // the gate can get closed right after the last message below the low
+    // watermark has been received, the timeout makes sure that we re-check the
+    // depth ourselves in that case
+    while (!m_bus_gate.is_open() && m_bus_depth.load(std::memory_order_acquire) > m_config.m_bus_low_watermark) {
+        spdlog::trace("waiting for the bus to drain");
+        co_await m_bus_gate.wait(std::chrono::milliseconds(250));
+    }
+}
+
+auto bot::request(message msg, std::chrono::steady_clock::duration timeout, std::optional<message_priority> priority) -> awaitable<std::optional<message_ptr>> {
+    auto executor = co_await asio::this_coro::executor;
+    auto channel = std::make_shared<reply_channel>(executor, 1uz);
+
+    // registered before the message is queued, the reply could otherwise
+    // beat us to it
+    const auto serial = m_previous_serial.fetch_add(1uz);
+    msg.m_serial = serial;
+
+    {
+        auto _ = std::unique_lock{m_requests_mutex};
+        m_pending_requests.emplace(serial, channel);
+    }
+
+    co_await enqueue(std::span{&msg, 1uz}, priority);
+
+    // the timeout and the router race for the entry and whoever takes it out
+    // of m_pending_requests is the only one to send on the channel, so the
+    // receive below completes exactly once: with the reply or with nothing
+    auto timer = asio::steady_timer{executor, timeout};
+    timer.async_wait([this, serial, channel](boost::system::error_code ec) {
+        if (ec) {
+            return;
+        }
+
+        auto _ = std::unique_lock{m_requests_mutex};
+        if (m_pending_requests.erase(serial) != 0uz) {
+            channel->try_send(asio::error::timed_out, message_ptr{});
+        }
+    });
+
+    auto reply = co_await channel->async_receive();
+    timer.cancel();
+
+    if (!reply) {
+        spdlog::debug("the request with serial {} (from \"{}\") has timed out", serial, msg.m_from);
+        co_return std::nullopt;
+    }
+
+    co_return std::move(*reply);
 }
 
 auto bot::queue_a_reply(message const& reply_to, std::string_view from_id, message_payload payload) -> awaitable<void> {
@@ -111,22 +315,165 @@ auto bot::queue_a_reply(message const& reply_to, std::string_view from_id, messa
     });
 }
 
-auto bot::handle_message(message msg) -> awaitable<void> {
-    spdlog::debug("new message with serial {} from \"{}\" addressed to \"{}\"", msg.m_serial, msg.m_from, msg.m_to);
+auto bot::deliver(thing_entry const& entry, message_ptr const& msg) -> awaitable<void> {
+    m_deliveries.fetch_add(1uz, std::memory_order_relaxed);
+
+    if (!co_await entry.m_mailbox->push(msg)) {
+        spdlog::debug("the mailbox of the `thing` \"{}\" overflowed while delivering the message with serial {}", entry.m_thing->get_id(), msg->m_serial);
+    }
+}
+
+auto bot::consumer(thing& thing, mailbox& box) -> awaitable<void> {
+    spdlog::debug("the consumer for the `thing` with the id \"{}\" has started", thing.get_id());
 
-    auto wrapper = [](thing& thing, message const& msg) -> awaitable<void> {
-        auto res = co_await thing.handle(msg);
+    for (;;) {
+        auto msg = co_await box.pop();
+        if (!msg) {
+            break;
+        }
+
+        auto res = co_await thing.handle(**msg);
         if (!res) {
             spdlog::error(
               "the `thing` \"{}\" returned an error while handling a message with serial {} (from \"{}\"): {}",  //
-              thing.get_id(), msg.m_serial, msg.m_from, static_cast<error const&>(res.error())
+              thing.get_id(), (*msg)->m_serial, (*msg)->m_from, static_cast<error const&>(res.error())
             );
         }
+    }
+
+    spdlog::debug("the consumer for the `thing` with the id \"{}\" has exited", thing.get_id());
+
+    co_await m_completion_channel.async_send({}, thing.get_id());
+}
+
+auto bot::coalesce(thing_entry const& connector, message_ptr const& msg, payloads::outgoing_message const& payload) -> awaitable<void> {
+    auto const& limits = *connector.m_coalescing;
+
+    if (auto it = m_pending_batches.find(payload.m_target); it != m_pending_batches.end()) {
+        auto& batch = it->second;
+        auto const& first_content = std::get<payloads::outgoing_message>(batch.m_first->m_payload).m_content;
+        auto const& current_content = batch.m_merged == 1uz ? first_content : batch.m_content;
+
+        if (current_content.size() + limits.m_separator.size() + payload.m_content.size() <= limits.m_max_size) {
+            if (batch.m_merged == 1uz) {
+                batch.m_content = first_content;
+            }
+
+            batch.m_content += limits.m_separator;
+            batch.m_content += payload.m_content;
+            batch.m_merged++;
+
+            m_coalesced.fetch_add(1uz, std::memory_order_relaxed);
+            co_return;
+        }
+
+        auto flushed = std::move(batch);
+        m_pending_batches.erase(it);
+        co_await deliver_batch(std::move(flushed));
+    }
+
+    if (payload.m_content.size() >= limits.m_max_size) {
+        co_await deliver(connector, msg);
         co_return;
-    };
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + m_config.m_coalesce_window;
+    m_next_flush = std::min(m_next_flush, deadline);
+
+    m_pending_batches.emplace(
+      payload.m_target,
+      pending_batch{
+        .m_connector = &connector,
+        .m_first = msg,
+        .m_content = {},
+        .m_merged = 1uz,
+        .m_deadline = deadline,
+      }
+    );
+}
+
+auto bot::flush_batches(std::span<const mini_kv> targets) -> awaitable<void> {
+    for (auto const& target : targets) {
+        if (auto node = m_pending_batches.extract(target); node) {
+            co_await deliver_batch(std::move(node.mapped()));
+        }
+    }
+}
+
+auto bot::flush_batches_due(bool everything) -> awaitable<void> {
+    using clock = std::chrono::steady_clock;
+
+    const auto now = clock::now();
+    if (!everything && now < m_next_flush) {
+        co_return;
+    }
+
+    auto due = std::vector<pending_batch>{};
+    m_next_flush = clock::time_point::max();
+
+    for (auto it = m_pending_batches.begin(); it != m_pending_batches.end();) {
+        if (everything || it->second.m_deadline <= now) {
+            due.emplace_back(std::move(it->second));
+            it = m_pending_batches.erase(it);
+            continue;
+        }
+
+        m_next_flush = std::min(m_next_flush, it->second.m_deadline);
+        ++it;
+    }
+
+    // a target has at most one batch, the order between targets doesn't matter
+    for (auto& batch : due) {
+        co_await deliver_batch(std::move(batch));
+    }
+}
+
+auto bot::deliver_batch(pending_batch batch) -> awaitable<void> {
+    if (batch.m_merged == 1uz) {
+        co_await deliver(*batch.m_connector, batch.m_first);
+        co_return;
+    }
+
+    spdlog::trace("sending {} merged outgoing messages (first serial: {})", batch.m_merged, batch.m_first->m_serial);
+
+    auto const& first = *batch.m_first;
+    auto merged = std::make_shared<const message>(message{
+      .m_from = first.m_from,
+      .m_to = first.m_to,
+
+      .m_serial = first.m_serial,
+      .m_reply_serial = first.m_reply_serial,
+
+      .m_payload =
+        payloads::outgoing_message{
+          .m_target = std::get<payloads::outgoing_message>(first.m_payload).m_target,
+          .m_content = std::move(batch.m_content),
+        },
+    });
+
+    co_await deliver(*batch.m_connector, merged);
+}
+
+auto bot::handle_message(message owned) -> awaitable<void> {
+    // the message is read-only once it's shared with the `thing`s, a new
+    // `thing` has to be taken out of it while we are the only owner
+    auto new_thing = std::unique_ptr<thing>{};
+    if (auto* const payload = std::get_if<payloads::add_thing>(&owned.m_payload); payload != nullptr) {
+        new_thing = std::move(payload->m_thing);
+    }
+
+    const auto msg = std::make_shared<const message>(std::move(owned));
+
+    spdlog::debug("new message with serial {} from \"{}\" addressed to \"{}\"", msg->m_serial, msg->m_from, msg->m_to);
+
+    auto internal_wrapper = [this, &new_thing](message const& msg) -> awaitable<void> {
+        auto res = result<void>{};
+        if (new_thing != nullptr) {
+            res = co_await add_thing(std::move(new_thing));
+        } else {
+            res = co_await handle_message_internal(msg);
+        }
 
-    auto internal_wrapper = [this](message msg) -> awaitable<void> {
-        auto res = co_await handle_message_internal(std::move(msg));
         if (!res) {
             spdlog::error("error while handling message internally: {}", static_cast<error const&>(res.error()));
         }
@@ -134,44 +481,62 @@ auto bot::handle_message(message msg) -> awaitable<void> {
         co_return;
     };
 
-    if (auto it = m_things.find("logger"); it != m_things.end()) {
-        auto res = co_await it->second->handle(msg);
-        if (!res) {
-            spdlog::warn("error while relaying message to logger: {}", static_cast<error const&>(res.error()));
-        }
+    auto* const logger = [this] -> thing_entry const* {
+        auto _ = std::shared_lock{m_things_mutex};
+        auto it = m_things.find("logger");
+        return it == m_things.end() ? nullptr : &it->second;
+    }();
+
+    if (logger != nullptr) {
+        co_await deliver(*logger, msg);
     }
 
-    if (auto* command = std::get_if<payloads::command>(&msg.m_payload); command != nullptr && !command->m_argv.empty()) {
-        spdlog::trace("message is a command, going to check persmission");
+    // replies to bot::request calls go to the caller and nowhere else
+    //
+    // the send happens under the lock so that request() can't give up on the
+    // reply in between. if it fails anyway the reply is routed like any other
+    // message.
+    if (msg->m_reply_serial) {
+        const auto handed_over = [&] {
+            auto _ = std::unique_lock{m_requests_mutex};
+
+            auto it = m_pending_requests.find(*msg->m_reply_serial);
+            if (it == m_pending_requests.end() || !it->second->try_send(boost::system::error_code{}, message_ptr{msg})) {
+                return false;
+            }
 
-        const auto sender = command->m_sender_identifier.serialize();
-        auto res = sqlite::query<int>(*m_database, "select level from user_levels where user_kv = ?", sender);
-        if (!res) {
-            spdlog::error("sql error while querying user level for \"{}\": {}", sender, static_cast<error const&>(res.error()));
-            co_await queue_a_reply(
-              msg, "bot",
-              payloads::outgoing_message{
-                .m_target = command->m_return_to_sender,
-                .m_content = "an error has ocurred, check logs",
-              }
-            );
+            m_pending_requests.erase(it);
+            return true;
+        }();
+
+        if (handed_over) {
             co_return;
         }
+    }
 
-        const auto user_level = res->empty() ? 0 : res->front();
+    thing_entry const* command_owner = nullptr;
 
-        if (auto it = m_declared_commands.find(command->m_argv[0]); it == m_declared_commands.end()) {
+    if (auto* command = std::get_if<payloads::command>(&msg->m_payload); command != nullptr && !command->m_argv.empty()) {
+        spdlog::trace("message is a command, going to check persmission");
+
+        const auto declared = [&] -> std::optional<declared_command> {
+            auto _ = std::shared_lock{m_things_mutex};
+            auto it = m_declared_commands.find(command->m_argv[0]);
+            return it == m_declared_commands.end() ? std::nullopt : std::optional{it->second};
+        }();
+
+        if (!declared) {
             co_await queue_a_reply(
-              msg, "bot",
+              *msg, "bot",
               payloads::outgoing_message{
                 .m_target = command->m_return_to_sender,
                 .m_content = "invalid command",
               }
             );
             co_return;
-        } else if (user_level < static_cast<int>(it->second.m_min_level)) {
+        } else if (!m_permissions.may_run(command->m_sender_identifier, command->m_argv[0], declared->m_decl.m_min_level)) {
             co_await queue_a_reply(
-              msg, "bot",
+              *msg, "bot",
               payloads::outgoing_message{
                 .m_target = command->m_return_to_sender,
                 .m_content = "insufficient permissions",
@@ -179,38 +544,109 @@ auto bot::handle_message(message msg) -> awaitable<void> {
             );
             co_return;
         }
+
+        command_owner = declared->m_owner;
     }
 
-    if (msg.m_to == "") {
-        using operation_t = decltype(asio::co_spawn(m_executor, std::declval<awaitable<void>>()));
-        auto workers = std::vector<operation_t>{};
-        for (auto& [id, thing] : m_things) {
-            if (id == "logger") {
-                continue; // already informed the logger
+    if (msg->m_to == "" && command_owner != nullptr) {
+        if (command_owner != logger) {
+            co_await deliver(*command_owner, msg);
+        }
+    } else if (msg->m_to == "") {
+        // entries are never erased and their addresses are stable, so it is
+        // fine to use them after the lock is gone
+        auto targets = std::vector<thing_entry const*>{};
+        const auto bit = payload_bit(msg->m_payload);
+
+        // outgoing messages go to the connector they are meant for, not to every connector
+        const auto* const outgoing = std::get_if<payloads::outgoing_message>(&msg->m_payload);
+        const auto* const multicast = std::get_if<payloads::multicast_message>(&msg->m_payload);
+
+        thing_entry const* coalesce_into = nullptr;
+        const auto coalescing = m_config.m_coalesce_window != std::chrono::milliseconds::zero();
+
+        {
+            auto _ = std::shared_lock{m_things_mutex};
+            targets.reserve(m_things.size());
+            for (auto const& [id, entry] : m_things) {
+                if (&entry == logger) {
+                    continue;  // already informed the logger
+                }
+
+                if ((entry.m_interests & bit) == 0) {
+                    continue;
+                }
+
+                if ((outgoing != nullptr || multicast != nullptr) && entry.m_connector) {
+                    continue;
+                }
+
+                targets.push_back(&entry);
+            }
+
+            if (outgoing != nullptr) {
+                const auto ident = outgoing->m_target["ident"];
+                if (auto it = ident ? m_connectors.find(*ident) : m_connectors.end(); it == m_connectors.end()) {
+                    spdlog::warn("an outgoing message with serial {} (from \"{}\") has no connector to go to", msg->m_serial, msg->m_from);
+                } else if (coalescing && it->second->m_coalescing) {
+                    coalesce_into = it->second;
+                } else {
+                    targets.push_back(it->second);
+                }
+            }
+
+            if (multicast != nullptr) {
+                const auto first_connector = targets.size();
+
+                for (auto const& target : multicast->m_targets) {
+                    const auto ident = target["ident"];
+                    auto it = ident ? m_connectors.find(*ident) : m_connectors.end();
+                    if (it == m_connectors.end()) {
+                        spdlog::warn("a multicast message with serial {} (from \"{}\") has a target with no connector to go to", msg->m_serial, msg->m_from);
+                        continue;
+                    }
+
+                    if (std::ranges::find(targets.begin() + first_connector, targets.end(), it->second) == targets.end()) {
+                        targets.push_back(it->second);
+                    }
+                }
             }
-            workers.push_back(asio::co_spawn(m_executor, wrapper(*thing, msg)));
         }
 
-        // parallel groups go wack if theres nothing to wait on
-        // truly experimental
-        workers.push_back(asio::co_spawn(m_executor, ([]() -> awaitable<void> { co_return; })()));
+        // whatever is waiting to be merged for these targets has to go out
+        // first or it would arrive after the multicast
+        if (coalescing && multicast != nullptr) {
+            co_await flush_batches(multicast->m_targets);
+        }
+
+        for (auto const* entry : targets) {
+            co_await deliver(*entry, msg);
+        }
 
-        co_await asio::experimental::make_parallel_group(std::move(workers)).async_wait(asio::experimental::wait_for_all(), asio::use_awaitable);
+        if (coalesce_into != nullptr) {
+            co_await coalesce(*coalesce_into, msg, *outgoing);
+        }
 
-        // handle the message internally last so that workers have a chance to quit
-        co_await internal_wrapper(std::move(msg));
-    } else if (msg.m_to == "bot") {
-        co_await internal_wrapper(std::move(msg));
+        // messages are only queued for the `thing`s here, handle the message
+        // internally last so that the `thing`s see an exit before their
+        // mailboxes get closed
+        co_await internal_wrapper(*msg);
+    } else if (msg->m_to == "bot") {
+        co_await internal_wrapper(*msg);
     } else {
-        auto it = m_things.find(msg.m_to);
+        auto const* const target = [&] -> thing_entry const* {
+            auto _ = std::shared_lock{m_things_mutex};
+            auto it = m_things.find(msg->m_to);
+            return it == m_things.end() ? nullptr : &it->second;
+        }();
 
-        if (it == m_things.end()) {
+        if (target == nullptr) {
             spdlog::warn(
               "a message from \"{}\" with serial {} is addressed to \"{}\" but no such `thing` has been registered",  //
-              msg.m_from, msg.m_serial, msg.m_to
+              msg->m_from, msg->m_serial, msg->m_to
             );
-        } else {
-            co_await wrapper(*(it->second), msg);
+        } else if (target != logger) {
+            co_await deliver(*target, msg);
         }
     }
 
@@ -218,7 +654,7 @@ auto bot::handle_message(message msg) -> awaitable<void> {
 }
 
 template<typename Payload>
-auto bot::handle_message_internal(message&& msg, [[maybe_unused]] Payload&& payload) -> awaitable<result<void>> {
+auto bot::handle_message_internal(message const& msg, [[maybe_unused]] Payload const& payload) -> awaitable<result<void>> {
     if (msg.m_to == "bot") {
         spdlog::warn("message (from \"{}\", serial: {}) addressed to be internally handled has no handler", msg.m_from, msg.m_serial);
     }
@@ -226,38 +662,89 @@ auto bot::handle_message_internal(message&& msg, [[maybe_unused]] Payload&& payl
 }
 
 template<>
-auto bot::handle_message_internal(message&& msg, [[maybe_unused]] payloads::exit&& payload) -> awaitable<result<void>> {
+auto bot::handle_message_internal(message const& msg, [[maybe_unused]] payloads::exit const& payload) -> awaitable<result<void>> {
+    spdlog::info("exit requested, closing the message lanes");
+
+    m_exiting = true;
+    m_control_channel.close();
     m_message_channel.close();
+    m_doorbell.close();
     co_return result<void>{};
 }
 
 template<>
-auto bot::handle_message_internal(message&& msg, [[maybe_unused]] payloads::command_decl&& payload) -> awaitable<result<void>> {
+auto bot::handle_message_internal(message const& msg, payloads::command_decl const& payload) -> awaitable<result<void>> {
+    auto _ = std::unique_lock{m_things_mutex};
     auto it = m_declared_commands.find(payload.m_command);
 
     if (it != m_declared_commands.end()) {
         co_return _anyhow_fmt("command \"{}\" is already added", payload.m_command);
     }
 
-    m_declared_commands.emplace_hint(it, payload.m_command, payload);
+    auto owner_it = m_things.find(std::string{msg.m_from});
+    if (owner_it == m_things.end()) {
+        spdlog::warn("the command \"{}\" is declared by \"{}\" which isn't a registered `thing`, it will be broadcast", payload.m_command, msg.m_from);
+    }
+
+    m_declared_commands.emplace_hint(
+      it, payload.m_command,
+      declared_command{
+        .m_decl = payload,
+        .m_owner = owner_it == m_things.end() ? nullptr : &owner_it->second,
+      }
+    );
 
     co_return result<void>{};
 }
 
-template<>
-auto bot::handle_message_internal(message&& msg, payloads::add_thing&& payload) -> awaitable<result<void>> {
-    auto key = std::string{payload.m_thing->get_id()};
+auto bot::add_thing(std::unique_ptr<thing> new_thing) -> awaitable<result<void>> {
+    auto key = std::string{new_thing->get_id()};
     spdlog::info("adding a new `thing` with the id \"{}\"", key);
 
-    auto [it, emplaced] = m_things.try_emplace(key, std::move(payload.m_thing));
-    if (!emplaced) {
+    const auto mailbox_config = new_thing->mailbox_config().value_or(m_config.m_default_mailbox);
+    const auto interests = new_thing->interests();
+    const auto connector_ident = new_thing->connector_ident();
+    const auto coalescing = new_thing->coalescing();
+
+    auto* const entry = [&] -> thing_entry* {
+        auto _ = std::unique_lock{m_things_mutex};
+
+        auto strand = asio::make_strand(m_executor);
+        auto [it, emplaced] = m_things.try_emplace(
+          key,
+          thing_entry{
+            .m_thing = std::move(new_thing),
+            .m_strand = strand,
+            .m_mailbox = std::make_unique<mailbox>(strand, mailbox_config),
+            .m_interests = interests,
+            .m_connector = connector_ident.has_value(),
+            .m_coalescing = coalescing,
+          }
+        );
+
+        if (!emplaced) {
+            return nullptr;
+        }
+
+        if (connector_ident && !m_connectors.try_emplace(*connector_ident, &it->second).second) {
+            spdlog::warn("the connector ident \"{}\" of the `thing` \"{}\" is already taken", *connector_ident, key);
+        }
+
+        return &it->second;
+    }();
+
+    if (entry == nullptr) {
         spdlog::warn("tried to add a `thing` with an id \"{}\" but it appears to already be registered", key);
         co_return result<void>{};
     }
 
+    auto* const thing_ptr = entry->m_thing.get();
+
+    asio::co_spawn(entry->m_strand, consumer(*thing_ptr, *entry->m_mailbox), asio::detached);
+
     asio::co_spawn(
-      m_executor,
-      [this, &thing = *(it->second)] -> awaitable<void> {
+      entry->m_strand,
+      [this, &thing = *thing_ptr] -> awaitable<void> {
           spdlog::debug("the worker for the `thing` with the id \"{}\" has started", thing.get_id());
 
           auto res = co_await thing.worker(*this);
@@ -277,12 +764,12 @@ auto bot::handle_message_internal(message&& msg, payloads::add_thing&& payload)
     co_return result<void>{};
 }
 
-auto bot::handle_message_internal(message msg) -> awaitable<result<void>> {
-    auto visitor = [this, &msg]<typename Payload>(Payload&& payload) -> awaitable<result<void>> {
-        return handle_message_internal<Payload>(std::move(msg), std::forward<Payload>(payload));
+auto bot::handle_message_internal(message const& msg) -> awaitable<result<void>> {
+    auto visitor = [this, &msg]<typename Payload>(Payload const& payload) -> awaitable<result<void>> {
+        return handle_message_internal<Payload>(msg, payload);  //
     };
 
-    return std::visit(visitor, std::move(msg.m_payload));
+    return std::visit(visitor, msg.m_payload);
 }
 
 }  // namespace john
@@ -9,6 +9,7 @@
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/detached.hpp>
+#include <boost/asio/write.hpp>
 
 namespace asio = boost::asio;
 using anyhow::result;
@@ -32,7 +33,7 @@ static void print_irc_message(message_view const& msg) {
     print_optional("user", msg.m_prefix_user);
     print_optional("host", msg.m_prefix_host);
 
-    spdlog::debug("command: {}", msg.m_command);
+    spdlog::debug("command: {} ({})", msg.m_command, msg.m_command_text);
 
     for (auto i = 0uz; auto const& param : msg.params()) {
         spdlog::debug("param #{}: \"{}\"", i++, param);
@@ -67,62 +68,88 @@ auto irc_client::run_inner() -> awaitable<std::expected<void, boost::system::err
     auto endpoint = TRYC(co_await resolver.async_resolve(m_config.m_server, std::to_string(m_config.m_port)));
     co_await m_socket.async_connect(endpoint->endpoint());
 
+    // whatever was left over belongs to the previous connection
+    m_incoming.clear();
+
+    if (!m_outgoing.empty()) {
+        spdlog::debug("dropping {} lines queued for the previous connection", m_outgoing.size());
+        m_outgoing.clear();
+        m_outgoing_depth.store(0uz, std::memory_order::relaxed);
+    }
+
+    // the strand we were spawned on, handlers must not run outside of it
+    auto strand = co_await asio::this_coro::executor;
+
+    asio::co_spawn(strand, writer(++m_connection_generation), asio::detached);
+
     co_await state_change(state::connected{});
 
     for (;;) {
-        auto unused_buffer = std::span{m_incoming_buffer.data() + m_incoming_buffer_usage, m_incoming_buffer.size() - m_incoming_buffer_usage};
+        // leave whatever the server sends in the socket buffer while the bot is
+        // catching up
+        co_await m_bot->wait_for_bus();
+
+        auto unused_buffer = m_incoming.prepare();
         auto read_byte_ct = TRYC(co_await m_socket.async_read_some(asio::buffer(unused_buffer)));
 
-        m_incoming_buffer_usage += read_byte_ct;
+        m_incoming.commit(read_byte_ct);
+
+        auto to_queue = std::vector<john::message>{};
 
         for (;;) {
-            const auto used_buffer = std::string_view{m_incoming_buffer.data(), m_incoming_buffer_usage};
-            const auto message_suffix_start = used_buffer.find("\r\n");
-            if (message_suffix_start == std::string_view::npos) {
+            auto line = m_incoming.next_line();
+            if (!line) {
+                spdlog::warn("{}", line.error().description());
+                continue;
+            }
+
+            if (!*line) {
                 break;
             }
 
-            const auto raw_message = used_buffer.substr(0, message_suffix_start + 2);
-            auto parse_result = message_view::from_chars(raw_message);
+            auto& [storage, raw_message] = **line;
+            auto parse_result = message_view::from_chars(raw_message, std::move(storage));
 
             if (!parse_result) {
                 spdlog::warn("failed to parse IRC message: {}", raw_message);
                 spdlog::warn("reason: {}", parse_result.error().description());
             } else {
-                asio::co_spawn(m_executor, message_handler(*parse_result), asio::detached);
+                co_await message_handler(*parse_result, to_queue);
             }
+        }
 
-            m_incoming_buffer_usage -= raw_message.size();
-            std::fill(std::copy(m_incoming_buffer.begin() + raw_message.size(), m_incoming_buffer.end(), m_incoming_buffer.begin()), m_incoming_buffer.end(), 0);
+        // a read can carry a lot of lines when a channel is busy
+        if (!to_queue.empty()) {
+            co_await m_bot->queue_messages(to_queue);
         }
     }
 
     co_return std::expected<void, boost::system::error_code>{};
 }
 
-auto irc_client::message_handler(message_view const& message) -> awaitable<void> {
+auto irc_client::message_handler(message_view const& message, std::vector<john::message>& to_queue) -> awaitable<void> {
     // print_irc_message(message);
 
-    if (message.m_command == reply{"PING"}) {
+    if (message.m_command == command_reply::PING) {
         if (message.m_trailing) {
-            co_await send_message(message::bare("PONG").with_trailing(std::string(*(message.m_trailing))));
+            send_message(message::bare("PONG").with_trailing(std::string(*(message.m_trailing))));
         } else {
-            co_await send_message(message::bare("PONG"));
+            send_message(message::bare("PONG"));
         }
     }
 
-    const auto params = std::vector(std::from_range, message.params());
+    const auto params = message.params();
 
     const auto state_visitor = stf::multi_visitor{
       [&](state::connected) -> awaitable<void> {
           if (message.m_command == reply{001}) {
               co_await state_change(state::registered{});
-          } else if (message.m_command == reply{numeric_reply::ERR_NICKNAMEINUSE}) {
+          } else if (message.m_command == numeric_reply::ERR_NICKNAMEINUSE) {
               co_await state_change(state::failure_registration{});
           }
       },
       [&](state::registered& state) -> awaitable<void> {
-          if (message.m_command == reply{"PRIVMSG"}) {
+          if (message.m_command == command_reply::PRIVMSG) {
               if (params.size() != 1uz) {
                   spdlog::error("PRIVMSG with #params != 1 (is {} instead)", params.size());
                   co_return;
@@ -173,7 +200,7 @@ auto irc_client::message_handler(message_view const& message) -> awaitable<void>
                   internal_message.m_payload = std::move(payload);
               }
 
-              co_await m_bot->queue_message(std::move(internal_message));
+              to_queue.emplace_back(std::move(internal_message));
           }
           co_return;  //
       },
@@ -188,13 +215,13 @@ auto irc_client::state_change(state_t new_state) -> awaitable<void> {
     const auto old_state = m_state;
     m_state = new_state;
 
-    auto try_register = [&](std::string_view nick, std::string_view user, std::string_view realname) -> awaitable<void> {
-        co_await send_message(message::bare("NICK").with_param(std::string(nick)));
-        co_await send_message(message::bare("USER")  //
-                                .with_param(m_config.m_user)
-                                .with_param("*")
-                                .with_param("*")
-                                .with_trailing(m_config.m_realname));
+    auto try_register = [&](std::string_view nick, std::string_view user, std::string_view realname) {
+        send_message(message::bare("NICK").with_param(std::string(nick)));
+        send_message(message::bare("USER")  //
+                       .with_param(m_config.m_user)
+                       .with_param("*")
+                       .with_param("*")
+                       .with_trailing(m_config.m_realname));
     };
 
     auto try_register_n = [&](usize n) { return try_register(m_config.m_nicks[n], m_config.m_user, m_config.m_realname); };
@@ -202,14 +229,14 @@ auto irc_client::state_change(state_t new_state) -> awaitable<void> {
     const auto state_visitor = stf::multi_visitor{
       [&](state::connected& state) -> awaitable<void> {
           if (m_config.m_password) {
-              co_await send_message(message::bare("PASS").with_param(*m_config.m_password));
+              send_message(message::bare("PASS").with_param(*m_config.m_password));
           }
 
           if (state.m_nick_try >= m_config.m_nicks.size()) {
               spdlog::error("ran out of nicks to try, oh well!");
               co_await state_change(state::failure_registration{});
           }
-          co_await try_register_n(state.m_nick_try);
+          try_register_n(state.m_nick_try);
 
           co_return;
       },
@@ -225,7 +252,7 @@ auto irc_client::state_change(state_t new_state) -> awaitable<void> {
           spdlog::debug("registered with nick {}", state.m_nick);
 
           for (auto const& chan : m_config.m_channels) {
-              co_await send_message(irc::message::bare("JOIN").with_param(chan));
+              send_message(irc::message::bare("JOIN").with_param(chan));
           }
           co_return;
       },
@@ -258,12 +285,64 @@ auto irc_client::state_change(state_t new_state) -> awaitable<void> {
     co_return;
 }
 
-auto irc_client::send_message(message const& msg) -> awaitable<void> {
-    auto strings_to_send = msg.encode();
+void irc_client::send_message(message const& msg) {
+    spdlog::trace("queueing a message with command {}", msg.m_command);
 
-    for (auto const& str : strings_to_send) {
-        spdlog::trace("sending a message with command {}", msg.m_command);
-        co_await m_socket.async_send(asio::const_buffer{str.data(), str.size()});
+    for (auto& str : msg.encode()) {
+        m_outgoing.emplace_back(std::move(str));
+    }
+
+    m_outgoing_depth.store(m_outgoing.size(), std::memory_order::relaxed);
+    m_outgoing_doorbell.try_send(boost::system::error_code{});
+}
+
+auto irc_client::writer(usize generation) -> awaitable<void> {
+    // one write per line would be one syscall per line, the kernel takes a
+    // bounded number of buffers per writev
+    constexpr auto max_lines_per_write = 64uz;
+
+    auto lines = std::vector<std::string>{};
+    auto buffers = std::vector<asio::const_buffer>{};
+
+    for (;;) {
+        if (generation != m_connection_generation) {
+            // a newer writer owns the queue, pass on any ring we might have
+            // swallowed
+            m_outgoing_doorbell.try_send(boost::system::error_code{});
+            break;
+        }
+
+        if (m_outgoing.empty()) {
+            if (auto res = co_await m_outgoing_doorbell.async_receive(); !res) {
+                break;
+            }
+            continue;
+        }
+
+        // the lines are moved out so that a reconnect can drop the queue while
+        // a write is still in flight
+        const auto count = std::min(m_outgoing.size(), max_lines_per_write);
+
+        lines.clear();
+        for (auto i = 0uz; i < count; i++) {
+            lines.emplace_back(std::move(m_outgoing.front()));
+            m_outgoing.pop_front();
+        }
+
+        // only once `lines` is done growing, short strings move along with it
+        buffers.clear();
+        for (auto const& line : lines) {
+            buffers.emplace_back(line.data(), line.size());
+        }
+
+        m_outgoing_depth.store(m_outgoing.size(), std::memory_order::relaxed);
+
+        spdlog::trace("writing {} lines, {} more queued", count, m_outgoing.size());
+
+        if (auto res = co_await asio::async_write(m_socket, buffers); !res) {
+            spdlog::warn("failed to write to the IRC socket: {}", res.error().what());
+            break;
+        }
     }
 }
 
@@ -272,19 +351,31 @@ auto irc_client::bot_message_handler(john::message const& msg, Payload const& pa
     co_return result<void>{};  //
 }
 
-template<>
-auto irc_client::bot_message_handler(john::message const& msg, payloads::outgoing_message const& payload) -> awaitable<result<void>> {
-    if (payload.m_target["ident"] != m_config.m_identifier) {
-        co_return result<void>{};
+void irc_client::send_to(mini_kv const& target, std::string_view content) {
+    if (target["ident"] != m_config.m_identifier) {
+        return;
     }
 
-    const auto target = payload.m_target["target"].value_or("");
+    const auto channel = target["target"].value_or("");
 
-    co_await send_message(message::bare("PRIVMSG").with_param(std::string(target)).with_trailing(payload.m_content));
+    send_message(message::bare("PRIVMSG").with_param(std::string(channel)).with_trailing(std::string(content)));
+}
 
+template<>
+auto irc_client::bot_message_handler(john::message const& msg, payloads::outgoing_message const& payload) -> awaitable<result<void>> {
+    send_to(payload.m_target, payload.m_content);
     co_return result<void>{};  //
 }
 
+template<>
+auto irc_client::bot_message_handler(john::message const& msg, payloads::multicast_message const& payload) -> awaitable<result<void>> {
+    for (auto const& target : payload.m_targets) {
+        send_to(target, *payload.m_content);
+    }
+
+    co_return result<void>{};
+}
+
 template<>
 auto irc_client::bot_message_handler(john::message const& msg, payloads::exit const& payload) -> awaitable<result<void>> {
     co_await state_change(state::disconnecting{});
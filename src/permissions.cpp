@@ -0,0 +1,151 @@
+#include <permissions.hpp>
+
+#include <sqlite/exec.hpp>
+#include <sqlite/query.hpp>
+#include <sqlite/rows.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace asio = boost::asio;
+using anyhow::result;
+using asio::awaitable;
+
+namespace john {
+
+auto permission_table::key_of(mini_kv const& user) -> std::string_view {
+    thread_local auto entries = std::vector<std::pair<std::string_view, std::string_view>>{};
+    thread_local auto buffer = std::string{};
+
+    entries.clear();
+    for (auto const& entry : user) {
+        entries.emplace_back(entry);
+    }
+
+    std::ranges::sort(entries);
+
+    // the same escaping as mini_kv::serialize
+    const auto append_escaped = [](std::string_view str) {
+        for (const auto c : str) {
+            if (c == ':' || c == ';' || c == '\\') {
+                buffer.push_back('\\');
+            }
+            buffer.push_back(c);
+        }
+    };
+
+    buffer.clear();
+    for (auto first = true; auto const& [k, v] : entries) {
+        if (!first) {
+            buffer.push_back(';');
+        }
+        first = false;
+
+        append_escaped(k);
+        buffer.push_back(':');
+        append_escaped(v);
+    }
+
+    return buffer;
+}
+
+auto permission_table::reload(sqlite::connection& db) -> result<void> {
+    auto users = decltype(m_users){};
+
+    // rows that were written by hand might be escaped or ordered differently,
+    // the round trip takes care of that
+    auto levels = TRY(sqlite::stream<std::string_view, int>(db, "select user_kv, level from user_levels"));
+    for (auto const& [user_kv, level] : levels) {
+        users[std::string{key_of(mini_kv::deserialize(user_kv))}].m_level = static_cast<user_level>(level);
+    }
+
+    TRY(levels.status());
+
+    auto grants = TRY(sqlite::stream<std::string_view, std::string_view>(db, "select user_kv, command from command_grants"));
+    for (auto const& [user_kv, command] : grants) {
+        users[std::string{key_of(mini_kv::deserialize(user_kv))}].m_grants.emplace(command);
+    }
+
+    TRY(grants.status());
+
+    spdlog::debug("loaded the permissions of {} user(s)", users.size());
+
+    auto _ = std::unique_lock{m_mutex};
+    std::swap(m_users, users);
+
+    return {};
+}
+
+auto permission_table::level_of(mini_kv const& user) const -> user_level {
+    const auto key = key_of(user);
+
+    auto _ = std::shared_lock{m_mutex};
+
+    if (auto it = m_users.find(key); it == m_users.end()) {
+        return user_level::regular;
+    } else {
+        return it->second.m_level;
+    }
+}
+
+auto permission_table::may_run(mini_kv const& user, std::string_view command, user_level min_level) const -> bool {
+    const auto key = key_of(user);
+
+    auto _ = std::shared_lock{m_mutex};
+
+    auto it = m_users.find(key);
+    if (it == m_users.end()) {
+        return static_cast<int>(min_level) <= static_cast<int>(user_level::regular);
+    }
+
+    auto const& set = it->second;
+    return static_cast<int>(min_level) <= static_cast<int>(set.m_level) || set.m_grants.contains(command);
+}
+
+auto permission_table::set_level(sqlite::async_database& db, mini_kv const& user, user_level level) -> awaitable<result<void>> {
+    TRYC(co_await db.run([this, key = std::string{key_of(user)}, level](sqlite::connection& conn) -> std::expected<void, sqlite::error> {
+        TRY(sqlite::exec(conn, "insert or replace into user_levels (user_kv, level) values (?, ?)", key, static_cast<int>(level)));
+
+        auto _ = std::unique_lock{m_mutex};
+        m_users[key].m_level = level;
+
+        return {};
+    }));
+
+    co_return result<void>{};
+}
+
+auto permission_table::grant(sqlite::async_database& db, mini_kv const& user, std::string_view command) -> awaitable<result<void>> {
+    TRYC(co_await db.run([this, key = std::string{key_of(user)}, command = std::string{command}](sqlite::connection& conn) -> std::expected<void, sqlite::error> {
+        TRY(sqlite::exec(conn, "insert or ignore into command_grants (user_kv, command) values (?, ?)", key, command));
+
+        auto _ = std::unique_lock{m_mutex};
+        m_users[key].m_grants.emplace(command);
+
+        return {};
+    }));
+
+    co_return result<void>{};
+}
+
+auto permission_table::revoke(sqlite::async_database& db, mini_kv const& user, std::string_view command) -> awaitable<result<void>> {
+    TRYC(co_await db.run([this, key = std::string{key_of(user)}, command = std::string{command}](sqlite::connection& conn) -> std::expected<void, sqlite::error> {
+        TRY(sqlite::exec(conn, "delete from command_grants where user_kv = ? and command = ?", key, command));
+
+        auto _ = std::unique_lock{m_mutex};
+        if (auto it = m_users.find(key); it != m_users.end()) {
+            if (auto grant_it = it->second.m_grants.find(command); grant_it != it->second.m_grants.end()) {
+                it->second.m_grants.erase(grant_it);
+            }
+        }
+
+        return {};
+    }));
+
+    co_return result<void>{};
+}
+
+}  // namespace john
@@ -1,35 +1,230 @@
 #include <sqlite/sqlite.hpp>
 
+#include <stuff/core/try.hpp>
 #include <stuff/scope/scope_guard.hpp>
 
-namespace sqlite {
-
-namespace {
+#include <spdlog/spdlog.h>
 
-struct sqlite_destroyer {
-    void operator()(sqlite3* resource) { sqlite3_close(resource); }
-};
+#include <utility>
 
-}  // namespace
+namespace sqlite {
 
 error::error(int code, std::string description)
     : m_code(code)
     , m_description(std::move(description))
     , m_formatted_desc(fmt::format("sqlite error with code {} ({}), description: {}", m_code, sqlite3_errstr(m_code), m_description)) {}
 
-auto open(const char* filename) -> std::expected<database, error> {
+statement_lease::~statement_lease() {
+    if (m_statement == nullptr) {
+        return;
+    }
+
+    sqlite3_reset(m_statement.get());
+    sqlite3_clear_bindings(m_statement.get());
+
+    m_connection->release(m_sql, std::move(m_statement));
+}
+
+connection::~connection() {
+    // statements have to be gone before the connection can be closed
+    m_cache.clear();
+    sqlite3_close(m_handle);
+}
+
+auto connection::acquire(std::string_view sql) -> std::expected<statement_lease, error> {
+    {
+        auto _ = std::unique_lock{m_cache_mutex};
+        if (auto it = m_cache.find(sql); it != m_cache.end() && !it->second.empty()) {
+            auto ret = statement_lease(*this, sql, std::move(it->second.back()));
+            it->second.pop_back();
+
+            m_hits.fetch_add(1uz, std::memory_order_relaxed);
+            return ret;
+        }
+    }
+
+    m_misses.fetch_add(1uz, std::memory_order_relaxed);
+
+    auto* raw_statement = (sqlite3_stmt*)nullptr;
+    if (auto res = sqlite3_prepare_v3(m_handle, sql.data(), static_cast<int>(sql.size()), SQLITE_PREPARE_PERSISTENT, &raw_statement, nullptr); res != SQLITE_OK) {
+        sqlite3_finalize(raw_statement);
+        return std::unexpected{error(res, sqlite3_errmsg(m_handle))};
+    }
+
+    return statement_lease(*this, sql, statement{raw_statement});
+}
+
+void connection::release(std::string_view sql, statement statement) {
+    auto _ = std::unique_lock{m_cache_mutex};
+
+    auto it = m_cache.find(sql);
+    if (it == m_cache.end()) {
+        if (m_cache.size() >= max_cached_statements) {
+            return;
+        }
+
+        it = m_cache.try_emplace(std::string{sql}).first;
+    }
+
+    it->second.emplace_back(std::move(statement));
+}
+
+auto connection::cache_stats() const -> statement_cache_stats {
+    auto cached = 0uz;
+    {
+        auto _ = std::unique_lock{m_cache_mutex};
+        for (auto const& [sql, statements] : m_cache) {
+            cached += statements.size();
+        }
+    }
+
+    return {
+      .m_hits = m_hits.load(std::memory_order_relaxed),
+      .m_misses = m_misses.load(std::memory_order_relaxed),
+      .m_cached = cached,
+    };
+}
+
+auto transaction::begin(connection& db, transaction_kind kind) -> std::expected<transaction, error> {
+    const auto* const sql = [kind] {
+        switch (kind) {
+            case transaction_kind::deferred: return "begin deferred";
+            case transaction_kind::immediate: return "begin immediate";
+            case transaction_kind::exclusive: return "begin exclusive";
+            default: std::unreachable();
+        }
+    }();
+
+    TRY(exec(db, sql));
+
+    return transaction(db);
+}
+
+transaction::~transaction() {
+    if (!active()) {
+        return;
+    }
+
+    if (auto res = rollback(); !res) {
+        spdlog::warn("failed to roll a transaction back: {}", res.error().description());
+    }
+}
+
+auto transaction::commit() -> std::expected<void, error> { return finish("commit"); }
+
+auto transaction::rollback() -> std::expected<void, error> { return finish("rollback"); }
+
+auto transaction::finish(const char* sql) -> std::expected<void, error> {
+    if (!active()) {
+        return {};
+    }
+
+    auto res = exec(*m_database, sql);
+
+    // sqlite rolls back by itself after some errors, in which case there is
+    // nothing left to finish. a failed commit that didn't do that (e.g. a
+    // SQLITE_BUSY) is still rolled back by the destructor.
+    if (res || sqlite3_get_autocommit(m_database->handle()) != 0) {
+        m_database = nullptr;
+    }
+
+    return res;
+}
+
+auto exec_script(connection& db, const char* sql) -> std::expected<void, error> {
+    if (auto res = sqlite3_exec(db.handle(), sql, nullptr, nullptr, nullptr); res != SQLITE_OK) {
+        return std::unexpected{error(res, sqlite3_errmsg(db.handle()))};
+    }
+
+    return {};
+}
+
+static auto pragma(connection& db, std::string const& statement) -> std::expected<void, error> {
+    if (auto res = sqlite3_exec(db.handle(), statement.c_str(), nullptr, nullptr, nullptr); res != SQLITE_OK) {
+        return std::unexpected{error(res, fmt::format("while running \"{}\": {}", statement, sqlite3_errmsg(db.handle())))};
+    }
+
+    return {};
+}
+
+static auto apply_options(connection& db, open_options const& options) -> std::expected<void, error> {
+    if (options.m_busy_timeout) {
+        sqlite3_busy_timeout(db.handle(), *options.m_busy_timeout);
+    }
+
+    if (!options.m_read_only && options.m_journal_mode != journal_mode::unchanged) {
+        const auto* const mode = [&] {
+            switch (options.m_journal_mode) {
+                case journal_mode::delete_: return "delete";
+                case journal_mode::truncate: return "truncate";
+                case journal_mode::persist: return "persist";
+                case journal_mode::memory: return "memory";
+                case journal_mode::wal: return "wal";
+                case journal_mode::off: return "off";
+                default: std::unreachable();
+            }
+        }();
+
+        TRY(pragma(db, fmt::format("pragma journal_mode = {}", mode)));
+    }
+
+    if (options.m_synchronous != synchronous_mode::unchanged) {
+        const auto* const mode = [&] {
+            switch (options.m_synchronous) {
+                case synchronous_mode::off: return "off";
+                case synchronous_mode::normal: return "normal";
+                case synchronous_mode::full: return "full";
+                case synchronous_mode::extra: return "extra";
+                default: std::unreachable();
+            }
+        }();
+
+        TRY(pragma(db, fmt::format("pragma synchronous = {}", mode)));
+    }
+
+    if (options.m_mmap_size) {
+        TRY(pragma(db, fmt::format("pragma mmap_size = {}", *options.m_mmap_size)));
+    }
+
+    if (options.m_cache_size) {
+        TRY(pragma(db, fmt::format("pragma cache_size = {}", *options.m_cache_size)));
+    }
+
+    return {};
+}
+
+auto open(const char* filename, open_options const& options) -> std::expected<database, error> {
+    const auto flags = options.m_read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+
     auto* db = (sqlite3*)nullptr;
-    auto result = sqlite3_open(filename, &db);
+    auto result = sqlite3_open_v2(filename, &db, flags, nullptr);
 
     auto in_case_of_throw = stf::scope_exit{[db] { sqlite3_close(db); }};
-    auto resource = database(db, sqlite_destroyer{});
+    auto resource = std::make_shared<connection>(db);
     in_case_of_throw.release();
 
     if (result != SQLITE_OK) {
         return std::unexpected{error(result, sqlite3_errmsg(db))};
     }
 
+    TRY(apply_options(*resource, options));
+
     return std::move(resource);
 }
 
+auto open_pool(const char* filename, open_options const& options, usize readers) -> std::expected<pool, error> {
+    // the writer goes first, it creates the file and switches it to WAL
+    auto ret = pool(TRY(open(filename, options)));
+
+    auto reader_options = options;
+    reader_options.m_read_only = true;
+
+    ret.m_readers.reserve(readers);
+    for (auto i = 0uz; i < readers; i++) {
+        ret.m_readers.emplace_back(TRY(open(filename, reader_options)));
+    }
+
+    return ret;
+}
+
 }  // namespace sqlite
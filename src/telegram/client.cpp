@@ -36,13 +36,13 @@ auto client::worker(bot& bot) -> awaitable<result<void>> {
 }
 
 template<typename T>
-auto client::handle_update(T const& update) -> awaitable<result<void>> {
+auto client::handle_update(T const& update) -> result<std::optional<message>> {
     spdlog::warn("unhandled telegram update");
-    co_return result<void>{};  //
+    return std::nullopt;  //
 }
 
 template<>
-auto client::handle_update(api::types::message const& msg) -> awaitable<result<void>> {
+auto client::handle_update(api::types::message const& msg) -> result<std::optional<message>> {
     using namespace std::string_literals;
     auto from_str = msg
                       .m_from  //
@@ -96,9 +96,7 @@ auto client::handle_update(api::types::message const& msg) -> awaitable<result<v
         };
     }
 
-    co_await m_bot->queue_message(std::move(internal_msg));
-
-    co_return result<void>{};
+    return internal_msg;
 }
 
 auto client::worker_inner() -> awaitable<result<void>> {
@@ -129,6 +127,10 @@ auto client::worker_inner() -> awaitable<result<void>> {
     }
 
     for (;;) {
+        // don't fetch any more updates while the bot is catching up, telegram
+        // will hold on to them for us
+        co_await m_bot->wait_for_bus();
+
         spdlog::debug("starting a long poll");
         const auto poll_result =
           TRYC(co_await api::get_updates(m_update_connection, api::types::update_type::message | api::types::update_type::edited_message, 600, highest_id + 1));
@@ -142,13 +144,21 @@ auto client::worker_inner() -> awaitable<result<void>> {
 
         spdlog::debug("received {} update(s) with the highest id of {}", poll_result.size(), highest_id);
 
+        auto messages = std::vector<message>{};
+        messages.reserve(poll_result.size());
+
         for (auto const& update : poll_result) {
-            auto res = co_await std::visit([this](auto const& update) { return this->handle_update(update); }, update.m_message);
+            auto res = std::visit([this](auto const& update) { return this->handle_update(update); }, update.m_message);
 
             if (!res) {
                 spdlog::warn("error while handling a telegram update: {}", static_cast<john::error const&>(res.error()));
+            } else if (*res) {
+                messages.emplace_back(std::move(**res));
             }
         }
+
+        // a poll can return up to 100 updates, queue them all in one go
+        co_await m_bot->queue_messages(messages);
     }
 
     co_return result<void>{};
@@ -159,13 +169,12 @@ auto client::bot_message_handler(john::message const& msg, Payload const& payloa
     co_return result<void>{};
 }
 
-template<>
-auto client::bot_message_handler(john::message const& msg, payloads::outgoing_message const& payload) -> awaitable<result<void>> {
-    if (payload.m_target["ident"] != m_config.m_identifier) {
-        co_return result<void>{};
+auto client::send_to(mini_kv const& target_kv, std::string_view content) -> awaitable<void> {
+    if (target_kv["ident"] != m_config.m_identifier) {
+        co_return;
     }
 
-    const auto target = payload.m_target["id"].and_then([](std::string_view chars) -> std::optional<i64> {
+    const auto target = target_kv["id"].and_then([](std::string_view chars) -> std::optional<i64> {
         auto channel_id = (i64)0;
         auto res = std::from_chars(chars.begin(), chars.end(), channel_id, 10);
 
@@ -177,13 +186,26 @@ auto client::bot_message_handler(john::message const& msg, payloads::outgoing_me
     });
 
     if (!target) {
-        co_return result<void>{};
+        co_return;
     }
 
-    auto res = co_await api::send_message(m_connection, *target, payload.m_content);
+    auto res = co_await api::send_message(m_connection, *target, content);
     if (!res) {
         spdlog::warn("{}", res.error().description());
     }
+}
+
+template<>
+auto client::bot_message_handler(john::message const& msg, payloads::outgoing_message const& payload) -> awaitable<result<void>> {
+    co_await send_to(payload.m_target, payload.m_content);
+    co_return result<void>{};
+}
+
+template<>
+auto client::bot_message_handler(john::message const& msg, payloads::multicast_message const& payload) -> awaitable<result<void>> {
+    for (auto const& target : payload.m_targets) {
+        co_await send_to(target, *payload.m_content);
+    }
 
     co_return result<void>{};
 }
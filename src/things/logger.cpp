@@ -42,6 +42,13 @@ auto logger::handle(john::message const& msg) -> awaitable<result<void>> {
               spdlog::debug("    #{}: {}", i++, arg);
           }
       },
+      [](payloads::multicast_message const& msg) {
+          spdlog::debug("payloads::multicast_message");
+          for (auto i = 0uz; auto const& target : msg.m_targets) {
+              spdlog::debug("  target #{}: {}", i++, target.serialize());
+          }
+          spdlog::debug("  content: {}", msg.m_content ? *msg.m_content : "");
+      },
       [](auto const&) { spdlog::debug("no logger is provided for the payload, sad!"); },
     };
 
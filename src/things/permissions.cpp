@@ -0,0 +1,121 @@
+#include <things/permissions.hpp>
+
+#include <sqlite/async.hpp>
+
+#include <magic_enum.hpp>
+
+#include <array>
+
+namespace asio = boost::asio;
+using anyhow::result;
+using asio::awaitable;
+
+namespace john::things {
+
+auto permissions::worker(john::bot& bot) -> awaitable<result<void>> {
+    m_bot = &bot;
+
+    constexpr auto decls = std::array{
+      payloads::command_decl{
+        .m_command = "setlevel",
+        .m_description = "sets the level of a user, the levels are regular, admin and op",
+        .m_min_level = user_level::op,
+      },
+      payloads::command_decl{
+        .m_command = "grant",
+        .m_description = "lets a user run a command regardless of their level",
+        .m_min_level = user_level::op,
+      },
+      payloads::command_decl{
+        .m_command = "revoke",
+        .m_description = "takes back a command given out with grant",
+        .m_min_level = user_level::op,
+      },
+      payloads::command_decl{
+        .m_command = "reloadperms",
+        .m_description = "re-reads the user levels and command grants from the database",
+        .m_min_level = user_level::op,
+      },
+    };
+
+    for (auto const& decl : decls) {
+        co_await bot.queue_message(message{
+          .m_from = get_id(),
+          .m_to = "bot",
+
+          .m_serial = 0uz,
+          .m_reply_serial{},
+
+          .m_payload = decl,
+        });
+    }
+
+    co_return result<void>{};
+}
+
+auto permissions::run_command(payloads::command const& cmd) -> awaitable<result<std::string>> {
+    auto& table = m_bot->get_permissions();
+    auto& db = m_bot->get_async_db();
+
+    auto const& name = cmd.m_argv.front();
+
+    if (name == "reloadperms") {
+        TRYC(co_await db.read([&table](sqlite::connection& conn) { return table.reload(conn); }));
+        co_return "reloaded the permissions";
+    }
+
+    if (cmd.m_argv.size() != 3) {
+        co_return fmt::format("{} requires 3 arguments", name);
+    }
+
+    const auto user = mini_kv::deserialize(cmd.m_argv[1]);
+
+    if (name == "setlevel") {
+        const auto level = magic_enum::enum_cast<user_level>(cmd.m_argv[2]);
+        if (!level) {
+            co_return fmt::format("unknown level \"{}\"", cmd.m_argv[2]);
+        }
+
+        TRYC(co_await table.set_level(db, user, *level));
+        co_return "set the level";
+    }
+
+    if (name == "grant") {
+        TRYC(co_await table.grant(db, user, cmd.m_argv[2]));
+        co_return "granted the command";
+    }
+
+    if (name == "revoke") {
+        TRYC(co_await table.revoke(db, user, cmd.m_argv[2]));
+        co_return "revoked the command";
+    }
+
+    co_return std::string{};
+}
+
+auto permissions::handle(john::message const& msg) -> awaitable<result<void>> {
+    const auto* const cmd = std::get_if<payloads::command>(&msg.m_payload);
+    if (cmd == nullptr || cmd->m_argv.empty()) {
+        co_return result<void>{};
+    }
+
+    auto res = co_await run_command(*cmd);
+
+    if (!res) {
+        spdlog::error("error while executing command with serial #{}: {}", msg.m_serial, static_cast<error const&>(res.error()));
+    } else if (res->empty()) {
+        co_return result<void>{};
+    }
+
+    co_await m_bot->queue_a_reply(
+      msg, get_id(),
+      payloads::outgoing_message{
+        .m_target = cmd->m_return_to_sender,
+        .m_content = res ? std::move(*res) : "an error has occurred, check logs",
+      }
+    );
+
+    co_return result<void>{};
+}
+
+}  // namespace john::things
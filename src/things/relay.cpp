@@ -1,7 +1,9 @@
 #include <things/relay.hpp>
 
-#include <sqlite/exec.hpp>
-#include <sqlite/query.hpp>
+#include <sqlite/async.hpp>
+
+#include <algorithm>
+#include <ranges>
 
 namespace asio = boost::asio;
 using anyhow::result;
@@ -9,9 +11,41 @@ using asio::awaitable;
 
 namespace john::things {
 
+auto relay::load_mappings() -> awaitable<result<void>> {
+    // only the strings are carried back from the database thread, the kvs are
+    // parsed here
+    const auto rows = TRYC(co_await m_bot->get_async_db().query<std::string, std::string>("select from_kv, to_kv from relay_mappings"));
+
+    auto added = 0uz;
+    for (auto const& [from, to] : rows) {
+        added += add_mapping(from, mini_kv::deserialize(to)) ? 1uz : 0uz;
+    }
+
+    spdlog::debug("loaded {} relay mapping(s)", added);
+
+    co_return result<void>{};
+}
+
+auto relay::add_mapping(std::string_view from, mini_kv to) -> bool {
+    return m_mappings.insert(from, std::move(to));  //
+}
+
+auto relay::fingerprint(std::string_view content, mini_kv const& target) -> u64 {
+    const auto content_hash = std::hash<std::string_view>{}(content);
+    const auto target_hash = std::hash<mini_kv>{}(target);
+
+    return static_cast<u64>(stf::hash_combine(content_hash, target_hash));
+}
+
 auto relay::worker(john::bot& bot) -> awaitable<result<void>> {
     m_bot = &bot;
 
+    // mappings added while this is loading end up in m_mappings either way,
+    // add_mapping skips the duplicates
+    if (auto res = co_await load_mappings(); !res) {
+        spdlog::error("failed to load the relay mappings: {}", static_cast<error const&>(res.error()));
+    }
+
     co_await bot.queue_message(message{
       .m_from = get_id(),
       .m_to = "bot",
@@ -22,7 +56,7 @@ auto relay::worker(john::bot& bot) -> awaitable<result<void>> {
       .m_payload =
         payloads::command_decl{
           .m_command = "addmap",
-          .m_description = "adds a unidirectional relay mapping",
+          .m_description = "adds a unidirectional relay mapping, the source may end with * to match by prefix",
           .m_min_level = user_level::op,
         },
     });
@@ -36,25 +70,58 @@ auto relay::handle(john::message const& msg) -> awaitable<result<void>> {
           using namespace std::string_literals;
           using namespace std::string_view_literals;
 
-          auto serialized_sender = payload.m_sender_identifier.serialize();
-          const auto pretty_nick = m_bot->display_name(payload.m_sender_identifier).value_or(std::move(serialized_sender));
+          m_targets.clear();
+          m_mappings.match(payload.m_return_to_sender, m_targets);
+
+          if (m_targets.empty()) {
+              co_return result<void>{};
+          }
 
-          for (auto const& to : TRYC(sqlite::query<std::string>(m_bot->get_db(), "select to_kv from relay_mappings where from_kv = ?", payload.m_return_to_sender.serialize()))) {
-              co_await m_bot->queue_message(john::message{
-                .m_from = get_id(),
-                .m_to = "",
+          // something we have relayed to this chat coming back to us, probably
+          // through another bridge or an echoing connector
+          if (m_recently_relayed.contains(fingerprint(payload.m_content, payload.m_return_to_sender))) {
+              // echoes can come in bursts, don't serialize for a log line that
+              // goes nowhere
+              if (spdlog::should_log(spdlog::level::debug)) {
+                  spdlog::debug("dropping a relay echo from {} ({} so far)", payload.m_return_to_sender.serialize(), m_recently_relayed.stats().m_hits);
+              }
+              co_return result<void>{};
+          }
 
-                .m_serial = 0,
-                .m_reply_serial = std::nullopt,
+          // formatted straight from the cached name, the identifier is only
+          // serialized for senders that don't have one
+          auto content = std::string{};
+          const auto format_content = [&](std::string_view name) { content = fmt::format("{}: {}", name, payload.m_content); };
+          if (!m_bot->with_display_name(payload.m_sender_identifier, format_content)) {
+              format_content(payload.m_sender_identifier.serialize());
+          }
 
-                .m_payload =
-                  john::payloads::outgoing_message{
-                    .m_target = john::mini_kv::deserialize(to),
-                    .m_content = fmt::format("{}: {}", pretty_nick, payload.m_content),
-                  },
-              });
+          for (const auto* const to : m_targets) {
+              m_recently_relayed.insert(fingerprint(content, *to));
           }
 
+          // one entry on the bus and one copy of the content no matter how
+          // many targets there are
+          auto relayed_payload = m_targets.size() == 1uz
+                                 ? message_payload{payloads::outgoing_message{
+                                     .m_target = *m_targets.front(),
+                                     .m_content = std::move(content),
+                                   }}
+                                 : message_payload{payloads::multicast_message{
+                                     .m_targets = m_targets | std::views::transform([](const auto* to) { return *to; }) | std::ranges::to<std::vector>(),
+                                     .m_content = std::make_shared<const std::string>(std::move(content)),
+                                   }};
+
+          co_await m_bot->queue_message(john::message{
+            .m_from = get_id(),
+            .m_to = "",
+
+            .m_serial = 0,
+            .m_reply_serial = std::nullopt,
+
+            .m_payload = std::move(relayed_payload),
+          });
+
           co_return result<void>{};
       },
       [&](payloads::command const& cmd) -> awaitable<result<void>> {
@@ -77,7 +144,7 @@ auto relay::handle(john::message const& msg) -> awaitable<result<void>> {
               co_return result<void>{};
           }
 
-          auto res = sqlite::exec(m_bot->get_db(), "insert into relay_mappings (from_kv, to_kv) values (?, ?)", cmd.m_argv[1], cmd.m_argv[2]);
+          auto res = co_await m_bot->get_async_db().exec("insert into relay_mappings (from_kv, to_kv) values (?, ?)", cmd.m_argv[1], cmd.m_argv[2]);
 
           if (!res) {
               spdlog::error("sqlite error while executing command with serial #{}: {}", msg.m_serial, static_cast<error const&>(res.error()));
@@ -89,6 +156,8 @@ auto relay::handle(john::message const& msg) -> awaitable<result<void>> {
                 }
               );
           } else {
+              add_mapping(cmd.m_argv[1], mini_kv::deserialize(cmd.m_argv[2]));
+
               co_await m_bot->queue_a_reply(
                 msg, get_id(),
                 payloads::outgoing_message{
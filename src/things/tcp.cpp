@@ -80,10 +80,23 @@ auto tcp_thing::client_worker(tcp::socket socket) -> awaitable<result<void>> {
 }
 
 auto tcp_thing::handle(john::message const& msg) -> awaitable<result<void>> {
-    if (const auto* const ptr = std::get_if<payloads::outgoing_message>(&msg.m_payload); ptr != nullptr) {
+    const auto* const content = [&msg] -> std::string const* {
+        if (const auto* const ptr = std::get_if<payloads::outgoing_message>(&msg.m_payload); ptr != nullptr) {
+            return &ptr->m_content;
+        }
+
+        // the clients see every message regardless of its target, once is enough
+        if (const auto* const ptr = std::get_if<payloads::multicast_message>(&msg.m_payload); ptr != nullptr) {
+            return ptr->m_content.get();
+        }
+
+        return nullptr;
+    }();
+
+    if (content != nullptr) {
         const auto _ = std::unique_lock{m_clients_mutex};
         for (auto& [id, cl] : m_clients) {
-            cl->m_chan.try_send(boost::system::error_code{}, ptr->m_content);
+            cl->m_chan.try_send(boost::system::error_code{}, *content);
         }
     }
 
@@ -0,0 +1,52 @@
+#include <bloom_filter.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(bloom_filter, basic) {
+    using namespace std::chrono_literals;
+
+    const auto start = john::rotating_bloom_filter::clock::now();
+    auto filter = john::rotating_bloom_filter{{.m_bits = 1uz << 12, .m_hashes = 4uz, .m_ttl = 10s}};
+
+    for (auto i = 0ull; i < 64; i++) {
+        filter.insert(std::hash<u64>{}(i) * 0x9E37'79B9'7F4A'7C15ull, start);
+    }
+
+    for (auto i = 0ull; i < 64; i++) {
+        ASSERT_TRUE(filter.contains(std::hash<u64>{}(i) * 0x9E37'79B9'7F4A'7C15ull, start));
+    }
+
+    auto false_positives = 0uz;
+    for (auto i = 64ull; i < 64 + 1024; i++) {
+        false_positives += filter.contains(std::hash<u64>{}(i) * 0x9E37'79B9'7F4A'7C15ull, start) ? 1uz : 0uz;
+    }
+
+    // ~1e-5 expected with these parameters
+    ASSERT_LT(false_positives, 8uz);
+
+    const auto stats = filter.stats();
+    ASSERT_EQ(stats.m_insertions, 64uz);
+    ASSERT_EQ(stats.m_queries, 64uz + 1024uz);
+    ASSERT_EQ(stats.m_hits, 64uz + false_positives);
+}
+
+TEST(bloom_filter, expiry) {
+    using namespace std::chrono_literals;
+
+    const auto start = john::rotating_bloom_filter::clock::now();
+    auto filter = john::rotating_bloom_filter{{.m_bits = 1uz << 12, .m_hashes = 4uz, .m_ttl = 10s}};
+
+    filter.insert(0x0123'4567'89AB'CDEFull, start);
+
+    // survives one rotation
+    ASSERT_TRUE(filter.contains(0x0123'4567'89AB'CDEFull, start + 15s));
+    ASSERT_EQ(filter.stats().m_rotations, 1uz);
+
+    // but not two
+    ASSERT_FALSE(filter.contains(0x0123'4567'89AB'CDEFull, start + 26s));
+    ASSERT_EQ(filter.stats().m_rotations, 2uz);
+
+    // nor a long gap
+    filter.insert(0x0123'4567'89AB'CDEFull, start + 26s);
+    ASSERT_FALSE(filter.contains(0x0123'4567'89AB'CDEFull, start + 60s));
+}
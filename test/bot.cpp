@@ -0,0 +1,254 @@
+#include <bot.hpp>
+
+#include <stuff/core/visitor.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <functional>
+#include <memory>
+
+namespace {
+
+namespace asio = boost::asio;
+using anyhow::result;
+using asio::awaitable;
+
+// writes down the content of every message it is handed into `seen`, which
+// outlives the bot
+struct recorder final : john::thing {
+    recorder(std::string id, std::vector<std::string>& seen, std::optional<std::string> ident = std::nullopt, john::payload_mask interests = 0)
+        : m_id(std::move(id))
+        , m_ident(std::move(ident))
+        , m_interests(interests)
+        , m_seen(&seen) {}
+
+    ~recorder() override = default;
+
+    auto get_id() const -> std::string_view override { return m_id; }
+
+    auto interests() const -> john::payload_mask override { return m_interests; }
+
+    auto connector_ident() const -> std::optional<std::string_view> override { return m_ident; }
+
+    auto coalescing() const -> std::optional<john::coalescing_limits> override { return m_coalescing; }
+
+    auto worker(john::bot& bot) -> awaitable<result<void>> override {
+        m_bot = &bot;
+        co_return result<void>{};
+    }
+
+    auto handle(john::message const& msg) -> awaitable<result<void>> override {
+        const auto visitor = stf::multi_visitor{
+          [this](john::payloads::outgoing_message const& payload) { m_seen->emplace_back(payload.m_content); },
+          [this](john::payloads::incoming_message const& payload) { m_seen->emplace_back(payload.m_content); },
+          [](auto const&) {},
+        };
+
+        std::visit(visitor, msg.m_payload);
+
+        if (m_replies && msg.m_to == m_id) {
+            co_await m_bot->queue_a_reply(msg, get_id(), john::payloads::outgoing_message{.m_target = {}, .m_content = "pong"});
+        }
+
+        co_return result<void>{};
+    }
+
+    std::string m_id;
+    std::optional<std::string> m_ident;
+    john::payload_mask m_interests;
+    std::optional<john::coalescing_limits> m_coalescing = std::nullopt;
+
+    // answers messages that are addressed to it with "pong"
+    bool m_replies = false;
+
+    std::vector<std::string>* m_seen;
+
+    john::bot* m_bot = nullptr;
+};
+
+auto make_message(std::string to, john::message_payload payload) -> john::message {
+    return john::message{
+      .m_from = "test",
+      .m_to = std::move(to),
+
+      .m_serial = 0uz,
+      .m_reply_serial = std::nullopt,
+
+      .m_payload = std::move(payload),
+    };
+}
+
+auto outgoing(std::string_view ident, std::string content) -> john::message {
+    return make_message(
+      "",
+      john::payloads::outgoing_message{
+        .m_target = john::mini_kv{{"ident", ident}, {"target", "#a"}},
+        .m_content = std::move(content),
+      }
+    );
+}
+
+// adds the `thing`s, runs `script` next to bot::run and returns once the bot
+// has exited
+void run_bot(john::bot_configuration config, std::vector<std::unique_ptr<recorder>> things, std::function<awaitable<void>(john::bot&)> script) {
+    auto context = asio::io_context{};
+    auto executor = asio::any_io_executor{context.get_executor()};
+
+    auto db = sqlite::open(":memory:");
+    ASSERT_TRUE(db);
+
+    auto bot = john::bot(sqlite::pool{*db}, executor, config);
+
+    asio::co_spawn(
+      executor,
+      [&] -> awaitable<void> {
+          for (auto& thing : things) {
+              co_await bot.queue_message(make_message("bot", john::payloads::add_thing{.m_thing = std::move(thing)}));
+          }
+
+          co_await script(bot);
+
+          // through the bulk lane so that it doesn't overtake anything
+          co_await bot.queue_message(make_message("bot", john::payloads::exit{}), john::message_priority::bulk);
+      },
+      asio::detached
+    );
+
+    auto res = std::optional<result<void>>{};
+    asio::co_spawn(executor, [&] -> awaitable<void> { res = co_await bot.run(); }, asio::detached);
+
+    context.run();
+
+    ASSERT_TRUE(res && *res);
+}
+
+}  // namespace
+
+TEST(bot, request_reply) {
+    using namespace std::chrono_literals;
+
+    auto responder_seen = std::vector<std::string>{};
+    auto silent_seen = std::vector<std::string>{};
+
+    auto things = std::vector<std::unique_ptr<recorder>>{};
+    things.emplace_back(std::make_unique<recorder>("responder", responder_seen))->m_replies = true;
+    things.emplace_back(std::make_unique<recorder>("silent", silent_seen));
+
+    auto answered = std::optional<john::message_ptr>{};
+    auto timed_out = std::optional<john::message_ptr>{};
+
+    run_bot({}, std::move(things), [&](john::bot& bot) -> awaitable<void> {
+        answered = co_await bot.request(make_message("responder", john::payloads::incoming_message{.m_content = "ping"}), 10s);
+        timed_out = co_await bot.request(make_message("silent", john::payloads::incoming_message{.m_content = "ping"}), 10ms);
+    });
+
+    ASSERT_TRUE(answered);
+    ASSERT_EQ(std::get<john::payloads::outgoing_message>((*answered)->m_payload).m_content, "pong");
+    ASSERT_EQ(responder_seen, (std::vector<std::string>{"ping"}));
+
+    ASSERT_FALSE(timed_out);
+    ASSERT_EQ(silent_seen, (std::vector<std::string>{"ping"}));
+}
+
+TEST(bot, coalesced_burst_keeps_order) {
+    using namespace std::chrono_literals;
+
+    auto seen = std::vector<std::string>{};
+
+    auto things = std::vector<std::unique_ptr<recorder>>{};
+    things.emplace_back(std::make_unique<recorder>("connector", seen, "irc_0"))->m_coalescing = john::coalescing_limits{.m_max_size = 16uz, .m_separator = "\n"};
+
+    // the window outlasts the test, only the oversized message can push the
+    // batch out
+    auto config = john::bot_configuration{};
+    config.m_coalesce_window = 1h;
+
+    run_bot(config, std::move(things), [](john::bot& bot) -> awaitable<void> {
+        for (auto const* content : {"a", "b", "c"}) {
+            co_await bot.queue_message(outgoing("irc_0", content));
+        }
+
+        co_await bot.queue_message(outgoing("irc_0", "much too long to be merged"));
+    });
+
+    ASSERT_EQ(seen, (std::vector<std::string>{"a\nb\nc", "much too long to be merged"}));
+}
+
+TEST(bot, bus_watermarks) {
+    auto config = john::bot_configuration{};
+    config.m_bus_high_watermark = 4uz;
+    config.m_bus_low_watermark = 1uz;
+
+    // whether the bus was congested after every step of the script
+    auto congested = std::vector<bool>{};
+
+    run_bot(config, {}, [&](john::bot& bot) -> awaitable<void> {
+        // bot::run is still loading the permissions, nothing gets taken off
+        // the bus until the script suspends
+        for (auto i = 0uz; i < 4uz; i++) {
+            co_await bot.queue_message(make_message("", john::payloads::incoming_message{.m_content = "x"}));
+            congested.push_back(bot.bus_congested());
+        }
+
+        co_await bot.wait_for_bus();
+        congested.push_back(bot.bus_congested());
+    });
+
+    ASSERT_EQ(congested, (std::vector<bool>{false, false, false, true, false}));
+}
+
+TEST(bot, control_overtakes_bulk) {
+    auto seen = std::vector<std::string>{};
+
+    auto things = std::vector<std::unique_ptr<recorder>>{};
+    things.emplace_back(std::make_unique<recorder>("recorder", seen, std::nullopt, john::payload_mask_of<john::payloads::incoming_message>()));
+
+    auto config = john::bot_configuration{};
+    config.m_control_burst = 2uz;
+
+    run_bot(config, std::move(things), [](john::bot& bot) -> awaitable<void> {
+        for (auto const* content : {"b1", "b2", "b3"}) {
+            co_await bot.queue_message(make_message("", john::payloads::incoming_message{.m_content = content}), john::message_priority::bulk);
+        }
+
+        for (auto const* content : {"c1", "c2", "c3"}) {
+            co_await bot.queue_message(make_message("", john::payloads::incoming_message{.m_content = content}), john::message_priority::control);
+        }
+    });
+
+    // everything is on the lanes before bot::run takes anything off of them.
+    // the add_thing in front of c1 is control traffic as well, so the first
+    // burst is cut short after c1.
+    ASSERT_EQ(seen, (std::vector<std::string>{"c1", "b1", "c2", "c3", "b2", "b3"}));
+}
+
+TEST(bot, outgoing_goes_to_its_connector) {
+    auto irc_0_seen = std::vector<std::string>{};
+    auto irc_1_seen = std::vector<std::string>{};
+    auto observer_seen = std::vector<std::string>{};
+
+    // the connectors would take every outgoing message if it was up to their
+    // interests
+    const auto interests = john::payload_mask_of<john::payloads::outgoing_message>();
+
+    auto things = std::vector<std::unique_ptr<recorder>>{};
+    things.emplace_back(std::make_unique<recorder>("irc_0", irc_0_seen, "irc_0", interests));
+    things.emplace_back(std::make_unique<recorder>("irc_1", irc_1_seen, "irc_1", interests));
+    things.emplace_back(std::make_unique<recorder>("observer", observer_seen, std::nullopt, interests));
+
+    run_bot({}, std::move(things), [](john::bot& bot) -> awaitable<void> {
+        co_await bot.queue_message(outgoing("irc_0", "first"));
+        co_await bot.queue_message(outgoing("irc_1", "second"));
+        co_await bot.queue_message(outgoing("irc_2", "nowhere"));
+    });
+
+    ASSERT_EQ(irc_0_seen, (std::vector<std::string>{"first"}));
+    ASSERT_EQ(irc_1_seen, (std::vector<std::string>{"second"}));
+
+    // `thing`s that aren't connectors still see everything they are interested in
+    ASSERT_EQ(observer_seen, (std::vector<std::string>{"first", "second", "nowhere"}));
+}
@@ -0,0 +1,62 @@
+#include <gate.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+
+namespace asio = boost::asio;
+using asio::awaitable;
+
+TEST(gate, open_wakes_waiters) {
+    using namespace std::chrono_literals;
+
+    auto context = asio::io_context{};
+    auto gate = john::gate{};
+    ASSERT_TRUE(gate.is_open());
+
+    gate.close();
+
+    auto woken = false;
+    asio::co_spawn(
+      context,
+      [&] -> awaitable<void> {
+          co_await gate.wait(1h);
+          woken = true;
+      },
+      asio::detached
+    );
+
+    context.poll();
+    ASSERT_FALSE(woken);
+
+    gate.open();
+    context.run();
+
+    ASSERT_TRUE(woken);
+    ASSERT_TRUE(gate.is_open());
+}
+
+TEST(gate, wait_times_out) {
+    using namespace std::chrono_literals;
+
+    auto context = asio::io_context{};
+    auto gate = john::gate{};
+    gate.close();
+
+    auto woken = false;
+    asio::co_spawn(
+      context,
+      [&] -> awaitable<void> {
+          co_await gate.wait(1ms);
+          woken = true;
+      },
+      asio::detached
+    );
+
+    context.run();
+
+    ASSERT_TRUE(woken);
+    ASSERT_FALSE(gate.is_open());
+}
@@ -21,3 +21,38 @@ TEST(kv, kv) {
     ASSERT_EQ(kv_0[0], (std::pair{"a", "b"}));
     ASSERT_EQ(kv_0[1], (std::pair{"Hello,", "world!"}));
 }
+
+TEST(kv, hash) {
+    const auto kv_0 = john::mini_kv{{"ident", "irc_0"}, {"nick", "amy"}};
+    const auto kv_1 = john::mini_kv{{"ident", "irc_0"}, {"nick", "rory"}};
+
+    ASSERT_EQ(std::hash<john::mini_kv>{}(kv_0), std::hash<john::mini_kv>{}(john::mini_kv{{"ident", "irc_0"}, {"nick", "amy"}}));
+    ASSERT_NE(std::hash<john::mini_kv>{}(kv_0), std::hash<john::mini_kv>{}(kv_1));
+}
+
+TEST(kv, hash_ignores_order) {
+    const auto kv_0 = john::mini_kv{{"ident", "irc_0"}, {"nick", "amy"}};
+    const auto kv_1 = john::mini_kv{{"nick", "amy"}, {"ident", "irc_0"}};
+
+    ASSERT_EQ(kv_0, kv_1);
+    ASSERT_EQ(std::hash<john::mini_kv>{}(kv_0), std::hash<john::mini_kv>{}(kv_1));
+
+    // a subset isn't equal
+    ASSERT_NE(kv_0, (john::mini_kv{{"ident", "irc_0"}}));
+    ASSERT_NE((john::mini_kv{{"ident", "irc_0"}}), kv_0);
+}
+
+TEST(kv, serialize_round_trip) {
+    const auto kv = john::mini_kv{{"ident", "irc_0"}, {"nick", "a:b;c\\d"}, {"", "no key"}};
+    const auto serialized = kv.serialize();
+
+    ASSERT_EQ(serialized, "ident:irc_0;nick:a\\:b\\;c\\\\d;:no key");
+
+    const auto deserialized = john::mini_kv::deserialize(serialized);
+    ASSERT_EQ(deserialized.size(), 3uz);
+    ASSERT_EQ(deserialized["nick"], "a:b;c\\d");
+    ASSERT_EQ(deserialized.serialize(), serialized);
+
+    ASSERT_EQ(john::mini_kv{}.serialize(), "");
+    ASSERT_TRUE(john::mini_kv::deserialize("").empty());
+}
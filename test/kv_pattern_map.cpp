@@ -0,0 +1,73 @@
+#include <kv_pattern_map.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace {
+
+auto matches(john::kv_pattern_map<int> const& map, john::mini_kv const& kv) -> std::vector<int> {
+    auto out = std::vector<int const*>{};
+    map.match(kv, out);
+
+    auto ret = std::vector<int>{};
+    for (const auto* const value : out) {
+        ret.emplace_back(*value);
+    }
+
+    std::ranges::sort(ret);
+    return ret;
+}
+
+}  // namespace
+
+TEST(kv_pattern_map, exact) {
+    auto map = john::kv_pattern_map<int>{};
+    ASSERT_TRUE(map.insert("ident:irc_0;target:#a", 0));
+    ASSERT_TRUE(map.insert("ident:irc_0;target:#a", 1));
+    ASSERT_FALSE(map.insert("ident:irc_0;target:#a", 1));
+    ASSERT_TRUE(map.insert("ident:irc_0;target:#b", 2));
+    ASSERT_EQ(map.size(), 3uz);
+
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#a"}}), (std::vector{0, 1}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#b"}}), (std::vector{2}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#ab"}}), (std::vector<int>{}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#"}}), (std::vector<int>{}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_1"}, {"target", "#a"}}), (std::vector<int>{}));
+}
+
+TEST(kv_pattern_map, wildcard) {
+    auto map = john::kv_pattern_map<int>{};
+    ASSERT_TRUE(map.insert("ident:irc_0;target:#*", 0));
+    ASSERT_TRUE(map.insert("ident:irc_0;target:#a", 1));
+    ASSERT_TRUE(map.insert("ident:irc_*", 2));
+    // the same value from two rules is only reported once
+    ASSERT_TRUE(map.insert("ident:irc_0;target:#a*", 1));
+
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#a"}}), (std::vector{0, 1, 2}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#abc"}}), (std::vector{0, 1, 2}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#"}}), (std::vector{0, 2}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_1"}, {"target", "#a"}}), (std::vector{2}));
+    ASSERT_EQ(matches(map, {{"ident", "telegram_0"}, {"id", "1"}}), (std::vector<int>{}));
+
+    map.clear();
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#a"}}), (std::vector<int>{}));
+
+    ASSERT_TRUE(map.insert("*", 3));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "#a"}}), (std::vector{3}));
+}
+
+TEST(kv_pattern_map, escapes) {
+    auto map = john::kv_pattern_map<int>{};
+    ASSERT_TRUE(map.insert("ident:irc_0;target:a\\:b", 0));
+    ASSERT_TRUE(map.insert("ident:irc_0;target:\\*", 1));
+    ASSERT_TRUE(map.insert("ident:irc_0;target:\\\\*", 2));
+
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "a:b"}}), (std::vector{0}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "*"}}), (std::vector{1}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "*x"}}), (std::vector<int>{}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "a"}}), (std::vector<int>{}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "\\"}}), (std::vector{2}));
+    ASSERT_EQ(matches(map, {{"ident", "irc_0"}, {"target", "\\x"}}), (std::vector{2}));
+}
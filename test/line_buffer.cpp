@@ -0,0 +1,111 @@
+#include <irc/line_buffer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <format>
+
+namespace {
+
+struct drained {
+    std::vector<john::irc::shared_line> m_lines;
+    usize m_errors = 0uz;
+
+    auto texts() const -> std::vector<std::string_view> {
+        auto ret = std::vector<std::string_view>{};
+        for (auto const& line : m_lines) {
+            ret.emplace_back(line.m_text);
+        }
+        return ret;
+    }
+};
+
+// feeds `data` in reads of at most `read_size` bytes like a socket would,
+// draining the buffer after every read
+void feed(john::irc::line_buffer& buffer, std::string_view data, drained& out, usize read_size = 4096uz) {
+    while (!data.empty()) {
+        auto space = buffer.prepare();
+        const auto count = std::min({space.size(), data.size(), read_size});
+
+        std::ranges::copy(data.substr(0, count), space.begin());
+        buffer.commit(count);
+        data.remove_prefix(count);
+
+        for (;;) {
+            auto line = buffer.next_line();
+            if (!line) {
+                ++out.m_errors;
+                continue;
+            }
+
+            if (!*line) {
+                break;
+            }
+
+            out.m_lines.emplace_back(std::move(**line));
+        }
+    }
+}
+
+}  // namespace
+
+TEST(line_buffer, split_reads) {
+    auto buffer = john::irc::line_buffer{};
+    auto out = drained{};
+
+    // the CRLF is split over two reads too
+    feed(buffer, "PING :a\r\nNICK amy\r\nPRIVMSG #a :hi\r\n", out, 1uz);
+
+    ASSERT_EQ(out.m_errors, 0uz);
+    ASSERT_EQ(out.texts(), (std::vector<std::string_view>{"PING :a\r\n", "NICK amy\r\n", "PRIVMSG #a :hi\r\n"}));
+}
+
+TEST(line_buffer, lines_outlive_chunks) {
+    // the smallest chunk a max length of 16 allows
+    auto buffer = john::irc::line_buffer{16uz, 32uz};
+    auto out = drained{};
+
+    auto expected = std::vector<std::string>{};
+    auto data = std::string{};
+    for (auto i = 0uz; i < 100uz; i++) {
+        auto line = std::format("line {}\r\n", i);
+        data += line;
+        expected.emplace_back(std::move(line));
+    }
+
+    feed(buffer, data, out, 7uz);
+
+    // any reuse of a chunk that is still referenced would show up here
+    ASSERT_EQ(out.m_errors, 0uz);
+    ASSERT_EQ(out.m_lines.size(), expected.size());
+    for (auto i = 0uz; i < expected.size(); i++) {
+        ASSERT_EQ(out.m_lines[i].m_text, expected[i]);
+    }
+}
+
+TEST(line_buffer, long_lines) {
+    auto buffer = john::irc::line_buffer{16uz, 32uz};
+    auto out = drained{};
+
+    const auto at_limit = std::string(14uz, 'B') + "\r\n";
+
+    feed(buffer, "short\r\n" + std::string(100uz, 'A') + "\r\nafter\r\n", out, 5uz);
+    // exactly at the limit, CRLF included
+    feed(buffer, at_limit, out);
+    // one byte over the limit
+    feed(buffer, std::string(15uz, 'C') + "\r\nlast\r\n", out);
+
+    ASSERT_EQ(out.m_errors, 2uz);
+    ASSERT_EQ(out.texts(), (std::vector<std::string_view>{"short\r\n", "after\r\n", at_limit, "last\r\n"}));
+}
+
+TEST(line_buffer, clear) {
+    auto buffer = john::irc::line_buffer{};
+    auto out = drained{};
+
+    feed(buffer, "half a li", out);
+    buffer.clear();
+    feed(buffer, "NICK amy\r\n", out);
+
+    ASSERT_EQ(out.texts(), (std::vector<std::string_view>{"NICK amy\r\n"}));
+}
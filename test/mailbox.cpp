@@ -0,0 +1,108 @@
+#include <mailbox.hpp>
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+namespace asio = boost::asio;
+using asio::awaitable;
+
+auto make_mailbox(asio::io_context& context, john::overflow_policy policy) -> std::unique_ptr<john::basic_mailbox<int>> {
+    return std::make_unique<john::basic_mailbox<int>>(context.get_executor(), john::mailbox_configuration{.m_capacity = 2uz, .m_policy = policy});
+}
+
+// 0 is the end-of-stream marker of a basic_mailbox<int>, don't push it
+auto push_all(john::basic_mailbox<int>& box, std::vector<int> items, std::vector<bool>& results) -> awaitable<void> {
+    for (const auto item : items) {
+        results.push_back(co_await box.push(item));
+    }
+}
+
+auto pop_n(john::basic_mailbox<int>& box, usize n, std::vector<int>& popped) -> awaitable<void> {
+    for (auto i = 0uz; i < n; i++) {
+        if (auto item = co_await box.pop(); item) {
+            popped.push_back(*item);
+        }
+    }
+}
+
+}  // namespace
+
+TEST(mailbox, block) {
+    auto context = asio::io_context{};
+    auto box = make_mailbox(context, john::overflow_policy::block);
+
+    auto pushed = std::vector<bool>{};
+    asio::co_spawn(context, push_all(*box, {1, 2, 3}, pushed), asio::detached);
+    context.poll();
+
+    // the third push waits for room
+    ASSERT_EQ(pushed, (std::vector<bool>{true, true}));
+    ASSERT_EQ(box->stats().m_depth, 3uz);
+
+    auto popped = std::vector<int>{};
+    asio::co_spawn(context, pop_n(*box, 3uz, popped), asio::detached);
+    context.run();
+
+    ASSERT_EQ(pushed, (std::vector<bool>{true, true, true}));
+    ASSERT_EQ(popped, (std::vector<int>{1, 2, 3}));
+
+    const auto stats = box->stats();
+    ASSERT_EQ(stats.m_depth, 0uz);
+    ASSERT_EQ(stats.m_delivered, 3uz);
+    ASSERT_EQ(stats.m_dropped, 0uz);
+}
+
+TEST(mailbox, drop_oldest) {
+    auto context = asio::io_context{};
+    auto box = make_mailbox(context, john::overflow_policy::drop_oldest);
+
+    auto pushed = std::vector<bool>{};
+    asio::co_spawn(context, push_all(*box, {1, 2, 3}, pushed), asio::detached);
+    context.run();
+    context.restart();
+
+    // the push itself goes through but reports the eviction
+    ASSERT_EQ(pushed, (std::vector<bool>{true, true, false}));
+
+    auto popped = std::vector<int>{};
+    asio::co_spawn(context, pop_n(*box, 2uz, popped), asio::detached);
+    context.run();
+
+    ASSERT_EQ(popped, (std::vector<int>{2, 3}));
+
+    const auto stats = box->stats();
+    ASSERT_EQ(stats.m_depth, 0uz);
+    ASSERT_EQ(stats.m_delivered, 2uz);
+    ASSERT_EQ(stats.m_dropped, 1uz);
+}
+
+TEST(mailbox, drop_newest) {
+    auto context = asio::io_context{};
+    auto box = make_mailbox(context, john::overflow_policy::drop_newest);
+
+    auto pushed = std::vector<bool>{};
+    asio::co_spawn(context, push_all(*box, {1, 2, 3}, pushed), asio::detached);
+    context.run();
+    context.restart();
+
+    ASSERT_EQ(pushed, (std::vector<bool>{true, true, false}));
+
+    auto popped = std::vector<int>{};
+    asio::co_spawn(context, pop_n(*box, 2uz, popped), asio::detached);
+    context.run();
+
+    ASSERT_EQ(popped, (std::vector<int>{1, 2}));
+
+    const auto stats = box->stats();
+    ASSERT_EQ(stats.m_depth, 0uz);
+    ASSERT_EQ(stats.m_delivered, 2uz);
+    ASSERT_EQ(stats.m_dropped, 1uz);
+}
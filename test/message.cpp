@@ -5,6 +5,8 @@
 using john::irc::message_view;
 
 void assert_messages_equal(message_view got, message_view expected) {
+    ASSERT_EQ(got.m_tags, expected.m_tags);
+
     ASSERT_EQ(got.m_prefix_name, expected.m_prefix_name);
     ASSERT_EQ(got.m_prefix_user, expected.m_prefix_user);
     ASSERT_EQ(got.m_prefix_host, expected.m_prefix_host);
@@ -37,7 +39,7 @@ TEST(irc, message) {
       "NICK amy\r\n",
       {
         .m_command = "NICK",
-        .m_params = "amy",
+        .m_params = {"amy"},
       }
     );
 
@@ -45,7 +47,7 @@ TEST(irc, message) {
       "USER amy * * :Amy Pond\r\n",
       {
         .m_command = "USER",
-        .m_params = "amy  *    *",
+        .m_params = {"amy", "*", "*"},
         .m_trailing = "Amy Pond",
       }
     );
@@ -55,7 +57,7 @@ TEST(irc, message) {
       {
         .m_prefix_name = "bar.example.com",
         .m_command = 1,
-        .m_params = "  amy ",
+        .m_params = {"amy"},
         .m_trailing = "Welcome to the blah blah",
       }
     );
@@ -65,7 +67,7 @@ TEST(irc, message) {
       {
         .m_prefix_name = "bar.example.com",
         .m_command = numeric_reply::ERR_NICKNAMEINUSE,
-        .m_params = "*  amy ",
+        .m_params = {"*", "amy"},
         .m_trailing = "Nickname is already in use.",
       }
     );
@@ -74,7 +76,7 @@ TEST(irc, message) {
       "PRIVMSG rory :Hey Rory...\r\n",
       {
         .m_command = "PRIVMSG",
-        .m_params = "rory",
+        .m_params = {"rory"},
         .m_trailing = "Hey Rory...",
       }
     );
@@ -86,7 +88,7 @@ TEST(irc, message) {
         .m_prefix_user = "amy",
         .m_prefix_host = "foo.example.com",
         .m_command = "PRIVMSG",
-        .m_params = "rory",
+        .m_params = {"rory"},
         .m_trailing = "Hey Rory...",
       }
     );
@@ -102,6 +104,131 @@ TEST(irc, message) {
     */
 }
 
+TEST(irc, message_tokenizer) {
+    // a colon only starts the trailing parameter at the start of a parameter
+    assert_valid_message(
+      ":nick!user@host MODE #chan +b  x:y!*@* :\r\n",
+      {
+        .m_prefix_name = "nick",
+        .m_prefix_user = "user",
+        .m_prefix_host = "host",
+        .m_command = "MODE",
+        .m_params = {"#chan", "+b", "x:y!*@*"},
+        .m_trailing = "",
+      }
+    );
+
+    // after 14 middle parameters the rest is the trailing one, colon or not
+    assert_valid_message(
+      "CMD 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16\r\n",
+      {
+        .m_command = "CMD",
+        .m_params = {"1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14"},
+        .m_trailing = "15 16",
+      }
+    );
+
+    // tokens and runs of spaces spanning several blocks
+    const auto long_param = std::string(70uz, 'p');
+    const auto line = ":" + std::string(40uz, 'n') + "@h PRIVMSG " + long_param + std::string(33uz, ' ') + "x :" + std::string(100uz, ' ') + "\r\n";
+    assert_valid_message(
+      line,
+      {
+        .m_prefix_name = std::string_view{line}.substr(1, 40),
+        .m_prefix_host = "h",
+        .m_command = "PRIVMSG",
+        .m_params = {long_param, "x"},
+        .m_trailing = std::string_view{line}.substr(line.size() - 102uz, 100uz),
+      }
+    );
+
+    ASSERT_FALSE(message_view::from_chars(":prefix.only   \r\n"));
+    ASSERT_FALSE(message_view::from_chars("NO CRLF"));
+}
+
+TEST(irc, message_tags) {
+    const auto chars = std::string_view{
+      "@time=2024-05-01T12:00:00.000Z;msgid=abc\\:def;+example.com/flag;account=amy;note=a\\sb\\\\c\\rd\\ne\\x;empty= :amy!amy@host PRIVMSG #a :hi there\r\n"
+    };
+
+    assert_valid_message(
+      chars,
+      {
+        .m_tags = chars.substr(1, chars.find(' ') - 1),
+        .m_prefix_name = "amy",
+        .m_prefix_user = "amy",
+        .m_prefix_host = "host",
+        .m_command = "PRIVMSG",
+        .m_params = {"#a"},
+        .m_trailing = "hi there",
+      }
+    );
+
+    const auto message = *message_view::from_chars(chars);
+
+    ASSERT_EQ(message.tag("time"), "2024-05-01T12:00:00.000Z");
+    ASSERT_EQ(message.raw_tag("msgid"), "abc\\:def");
+    ASSERT_EQ(message.tag("msgid"), "abc;def");
+    ASSERT_EQ(message.tag("+example.com/flag"), "");
+    ASSERT_EQ(message.tag("account"), "amy");
+    ASSERT_EQ(message.tag("note"), "a b\\c\rd\nex");
+    ASSERT_EQ(message.tag("empty"), "");
+    ASSERT_EQ(message.tag("acc"), std::nullopt);
+    ASSERT_EQ(message.tag("example.com/flag"), std::nullopt);
+
+    // the last one wins
+    ASSERT_EQ(message_view::from_chars("@a=1;a=2 PING\r\n")->tag("a"), "2");
+
+    // no tags at all
+    ASSERT_EQ(message_view::from_chars("PING :x\r\n")->tag("time"), std::nullopt);
+    ASSERT_FALSE(message_view::from_chars("@a=1\r\n"));
+}
+
+TEST(irc, reply) {
+    using john::irc::command_reply;
+    using john::irc::numeric_reply;
+    using john::irc::reply;
+
+    ASSERT_EQ(reply{"PRIVMSG"}, command_reply::PRIVMSG);
+    ASSERT_EQ(reply{"TAGMSG"}, command_reply::TAGMSG);
+    ASSERT_EQ(reply{"433"}, numeric_reply::ERR_NICKNAMEINUSE);
+    ASSERT_EQ(reply{"001"}, reply{1});
+    ASSERT_TRUE(reply{"001"}.is_numeric());
+    ASSERT_EQ(reply{"001"}.name(), nullptr);
+    ASSERT_STREQ(reply{"433"}.name(), "ERR_NICKNAMEINUSE");
+    ASSERT_STREQ(reply{"JOIN"}.name(), "JOIN");
+
+    // neither known nor numerics
+    ASSERT_EQ(reply{"privmsg"}, reply{});
+    ASSERT_EQ(reply{"PRIVMSGS"}, reply{});
+    ASSERT_EQ(reply{"1000"}, reply{});
+    ASSERT_EQ(reply{"1a1"}, reply{});
+    ASSERT_EQ(reply{1000}, reply{});
+    ASSERT_FALSE(reply{"FOO"}.is_command());
+    ASSERT_FALSE(reply{"FOO"}.is_numeric());
+
+    const auto message = message_view::from_chars(":a FOO bar\r\n");
+    ASSERT_TRUE(message);
+    ASSERT_EQ(message->m_command, reply{});
+    ASSERT_EQ(message->m_command_text, "FOO");
+}
+
+TEST(irc, find_crlf) {
+    using john::irc::detail::find_crlf;
+
+    ASSERT_EQ(find_crlf(""), std::string_view::npos);
+    ASSERT_EQ(find_crlf("\r\n"), 0uz);
+    ASSERT_EQ(find_crlf("\n\r"), std::string_view::npos);
+    ASSERT_EQ(find_crlf("\r\r\n"), 1uz);
+
+    // the CR and the LF in different blocks, for every block size in use
+    for (auto offset = 0uz; offset < 70uz; offset++) {
+        const auto data = std::string(offset, 'a') + "\r\n" + std::string(70uz, 'b');
+        ASSERT_EQ(find_crlf(data), offset);
+        ASSERT_EQ(find_crlf(data, offset + 1uz), std::string_view::npos);
+    }
+}
+
 TEST(irc, message_trailing_split) {
     auto messages = john::irc::message::bare("PRIVMSG").with_param("#test").with_trailing(std::string(512, 'A')).encode();
     ASSERT_EQ(messages.size(), 2uz);
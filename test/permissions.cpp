@@ -0,0 +1,29 @@
+#include <permissions.hpp>
+
+#include <sqlite/sqlite.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(permissions, entry_order) {
+    auto db = sqlite::open(":memory:");
+    ASSERT_TRUE(db);
+
+    ASSERT_TRUE(sqlite::exec_script(**db, R"(
+        create table user_levels (user_kv text not null, level int not null, primary key (user_kv));
+        create table command_grants (user_kv text not null, command text not null, primary key (user_kv, command));
+
+        insert into user_levels (user_kv, level) values ('nick:amy;ident:irc_0', 2);
+        insert into command_grants (user_kv, command) values ('ident:irc_0;nick:rory', 'addmap');
+    )"));
+
+    auto table = john::permission_table{};
+    ASSERT_TRUE(table.reload(**db));
+
+    // the way a connector would put them together, not the way they were typed
+    ASSERT_EQ(table.level_of(john::mini_kv{{"ident", "irc_0"}, {"nick", "amy"}}), john::user_level::op);
+    ASSERT_EQ(table.level_of(john::mini_kv{{"nick", "amy"}, {"ident", "irc_0"}}), john::user_level::op);
+    ASSERT_EQ(table.level_of(john::mini_kv{{"ident", "irc_1"}, {"nick", "amy"}}), john::user_level::regular);
+
+    ASSERT_TRUE(table.may_run(john::mini_kv{{"nick", "rory"}, {"ident", "irc_0"}}, "addmap", john::user_level::op));
+    ASSERT_FALSE(table.may_run(john::mini_kv{{"nick", "rory"}, {"ident", "irc_0"}}, "setlevel", john::user_level::op));
+}
@@ -0,0 +1,160 @@
+#include <sqlite/sqlite.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+auto make_database() -> sqlite::database {
+    auto db = sqlite::open(":memory:");
+    EXPECT_TRUE(db);
+
+    EXPECT_TRUE(sqlite::exec(**db, "create table numbers (number integer not null, name text not null)"));
+    for (auto i = 0; i < 16; i++) {
+        EXPECT_TRUE(sqlite::exec(**db, "insert into numbers (number, name) values (?, ?)", i, std::to_string(i)));
+    }
+
+    return *db;
+}
+
+}  // namespace
+
+TEST(sqlite, stream) {
+    auto db = make_database();
+
+    auto rows = sqlite::stream<int, std::string_view>(*db, "select number, name from numbers order by number");
+    ASSERT_TRUE(rows);
+
+    auto expected = 0;
+    for (auto const& [number, name] : *rows) {
+        ASSERT_EQ(number, expected);
+        ASSERT_EQ(name, std::to_string(expected));
+        expected++;
+    }
+
+    ASSERT_EQ(expected, 16);
+    ASSERT_TRUE(rows->status());
+
+    // the statement has been handed back by now and can be reused
+    const auto again = sqlite::query<int>(*db, "select number, name from numbers order by number");
+    ASSERT_TRUE(again);
+    ASSERT_EQ(again->size(), 16uz);
+}
+
+TEST(sqlite, stream_early_exit) {
+    auto db = make_database();
+
+    {
+        auto rows = sqlite::stream<int>(*db, "select number from numbers where number >= ?", 8);
+        ASSERT_TRUE(rows);
+
+        auto it = rows->begin();
+        ASSERT_NE(it, rows->end());
+        ASSERT_EQ(*it, 8);
+    }
+
+    // leaving the range behind halfway through must not leave the cached
+    // statement mid-step
+    auto count = 0;
+    auto rows = sqlite::stream<int>(*db, "select number from numbers where number >= ?", 12);
+    ASSERT_TRUE(rows);
+    for (auto number : *rows) {
+        ASSERT_GE(number, 12);
+        count++;
+    }
+
+    ASSERT_EQ(count, 4);
+}
+
+TEST(sqlite, stream_error) {
+    auto db = make_database();
+
+    const auto rows = sqlite::stream<int>(*db, "select number from no_such_table");
+    ASSERT_FALSE(rows);
+}
+
+TEST(sqlite, binders) {
+    auto db = sqlite::open(":memory:");
+    ASSERT_TRUE(db);
+    ASSERT_TRUE(sqlite::exec(**db, "create table things (big integer, real real, data blob, maybe text)"));
+
+    const auto big = i64{1} << 40;
+    const auto data = std::vector<std::byte>{std::byte{0}, std::byte{1}, std::byte{0xFF}};
+
+    ASSERT_TRUE(sqlite::exec(**db, "insert into things values (?, ?, ?, ?)", big, 0.5, data, std::optional<std::string>{"hello"}));
+    ASSERT_TRUE(sqlite::exec(**db, "insert into things values (?, ?, ?, ?)", i64{-1}, 1.5, std::span<const std::byte>{}, std::nullopt));
+
+    const auto rows = sqlite::query<i64, double, std::vector<std::byte>, std::optional<std::string>>(**db, "select * from things order by rowid");
+    ASSERT_TRUE(rows);
+    ASSERT_EQ(rows->size(), 2uz);
+
+    ASSERT_EQ(std::get<0>((*rows)[0]), big);
+    ASSERT_EQ(std::get<1>((*rows)[0]), 0.5);
+    ASSERT_EQ(std::get<2>((*rows)[0]), data);
+    ASSERT_EQ(std::get<3>((*rows)[0]), std::optional<std::string>{"hello"});
+
+    ASSERT_EQ(std::get<0>((*rows)[1]), -1);
+    ASSERT_TRUE(std::get<2>((*rows)[1]).empty());
+    ASSERT_EQ(std::get<3>((*rows)[1]), std::nullopt);
+}
+
+TEST(sqlite, transaction) {
+    auto db = make_database();
+
+    {
+        auto transaction = sqlite::transaction::begin(*db);
+        ASSERT_TRUE(transaction);
+        ASSERT_TRUE(sqlite::exec(*db, "delete from numbers"));
+        // not committed, rolled back here
+    }
+
+    ASSERT_EQ(sqlite::query<int>(*db, "select count(*) from numbers")->front(), 16);
+
+    {
+        auto transaction = sqlite::transaction::begin(*db);
+        ASSERT_TRUE(transaction);
+        ASSERT_FALSE(sqlite::transaction::begin(*db));
+        ASSERT_TRUE(sqlite::exec(*db, "delete from numbers where number >= ?", 8));
+        ASSERT_TRUE(transaction->commit());
+        ASSERT_FALSE(transaction->active());
+    }
+
+    ASSERT_EQ(sqlite::query<int>(*db, "select count(*) from numbers")->front(), 8);
+}
+
+TEST(sqlite, exec_many) {
+    auto db = make_database();
+
+    auto rows = std::vector<std::tuple<int, std::string>>{};
+    for (auto i = 16; i < 1024; i++) {
+        rows.emplace_back(i, std::to_string(i));
+    }
+
+    const auto res = sqlite::exec_many(*db, "insert into numbers (number, name) values (?, ?)", rows);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(*res, rows.size());
+    ASSERT_EQ(sqlite::query<int>(*db, "select count(*) from numbers")->front(), 1024);
+
+    // a failing row takes the whole batch with it
+    ASSERT_TRUE(sqlite::exec(*db, "create unique index numbers_unique on numbers (number)"));
+    const auto duplicates = std::vector<std::tuple<int, std::string>>{{2048, "new"}, {0, "duplicate"}};
+    ASSERT_FALSE(sqlite::exec_many(*db, "insert into numbers (number, name) values (?, ?)", duplicates));
+    ASSERT_EQ(sqlite::query<int>(*db, "select count(*) from numbers")->front(), 1024);
+}
+
+TEST(sqlite, exec_many_bind_error) {
+    auto db = make_database();
+
+    // anything longer than this fails to bind
+    sqlite3_limit(db->handle(), SQLITE_LIMIT_LENGTH, 64);
+
+    const auto rows = std::vector<std::tuple<int, std::string>>{{2048, "short"}, {2049, std::string(128uz, 'x')}};
+    ASSERT_FALSE(sqlite::exec_many(*db, "insert into numbers (number, name) values (?, ?)", rows));
+
+    // the row before the one that failed is rolled back too
+    ASSERT_EQ(sqlite::query<int>(*db, "select count(*) from numbers")->front(), 16);
+
+    // more values than placeholders
+    const auto wide = std::vector<std::tuple<int, std::string, int>>{{4096, "wide", 0}};
+    ASSERT_FALSE(sqlite::exec_many(*db, "insert into numbers (number, name) values (?, ?)", wide));
+    ASSERT_EQ(sqlite::query<int>(*db, "select count(*) from numbers")->front(), 16);
+}